@@ -0,0 +1,195 @@
+#include <new>
+#include <chrono>
+#include <string>
+#include <cstdlib>
+#include <iostream>
+
+#include "../bson.hpp"
+
+// every heap allocation is counted, so both representations are measured the same way
+static std::size_t allocated_bytes = 0;
+static std::size_t allocated_count = 0;
+
+void * operator new( std::size_t size )
+{
+	allocated_bytes += size;
+	allocated_count++;
+
+	if( void * ptr = std::malloc( size != 0 ? size : 1 ) )
+	{
+		return ptr;
+	}
+
+	throw std::bad_alloc();
+}
+void * operator new( std::size_t size, std::align_val_t align )
+{
+	allocated_bytes += size;
+	allocated_count++;
+
+	std::size_t alignment = static_cast<std::size_t>( align );
+#ifdef WIN32
+	void * ptr = _aligned_malloc( size != 0 ? size : 1, alignment );
+#else
+	std::size_t rounded = ( size + alignment - 1 ) / alignment * alignment;
+	void * ptr = std::aligned_alloc( alignment, rounded != 0 ? rounded : alignment );
+#endif // WIN32
+	if( ptr != nullptr )
+	{
+		return ptr;
+	}
+
+	throw std::bad_alloc();
+}
+void operator delete( void * ptr ) noexcept
+{
+	std::free( ptr );
+}
+void operator delete( void * ptr, std::size_t ) noexcept
+{
+	std::free( ptr );
+}
+void operator delete( void * ptr, std::align_val_t ) noexcept
+{
+#ifdef WIN32
+	_aligned_free( ptr );
+#else
+	std::free( ptr );
+#endif // WIN32
+}
+void operator delete( void * ptr, std::size_t, std::align_val_t ) noexcept
+{
+#ifdef WIN32
+	_aligned_free( ptr );
+#else
+	std::free( ptr );
+#endif // WIN32
+}
+
+template< typename F > static double measure( int rounds, F && func )
+{
+	double best = 0;
+
+	for( int i = 0; i < rounds; i++ )
+	{
+		auto beg = std::chrono::steady_clock::now();
+		func();
+		auto end = std::chrono::steady_clock::now();
+
+		double ms = std::chrono::duration<double, std::milli>( end - beg ).count();
+		if( i == 0 || ms < best )
+		{
+			best = ms;
+		}
+	}
+
+	return best;
+}
+
+int main()
+{
+	// wide and flat: many small scalar fields are where a variant node costs the most
+	bson::builder build;
+	for( std::int32_t i = 0; i < 1000; i++ )
+	{
+		build.append( "field_" + std::to_string( i ), i );
+	}
+	for( int i = 0; i < 200; i++ )
+	{
+		build.append( "str_" + std::to_string( i ), "value string " + std::to_string( i ) );
+	}
+
+	bson::document_view view = build.finish();
+
+	std::cout << "wide document: 1200 fields, " << view.get_size() << " bytes encoded" << std::endl;
+
+	{
+		std::size_t bytes = allocated_bytes, count = allocated_count;
+		bson::document_t doc;
+		doc.deserialize( view );
+		std::cout << "document_t:       " << allocated_bytes - bytes << " bytes in " << allocated_count - count << " allocations, sizeof( node_t ) = " << sizeof( bson::node_t ) << std::endl;
+	}
+	{
+		std::size_t bytes = allocated_bytes, count = allocated_count;
+		bson::compact_document doc( view );
+		std::cout << "compact_document: " << allocated_bytes - bytes << " bytes in " << allocated_count - count << " allocations, sizeof( cell ) = " << sizeof( bson::compact_document::cell ) << std::endl;
+	}
+
+	const int repeat = 1000;
+	std::int64_t check = 0;
+
+	double doc_decode = measure( 5, [&]()
+	{
+		for( int i = 0; i < repeat; i++ )
+		{
+			bson::document_t doc;
+			doc.deserialize( view );
+			check += doc.get_size();
+		}
+	} );
+	double compact_decode = measure( 5, [&]()
+	{
+		for( int i = 0; i < repeat; i++ )
+		{
+			bson::compact_document doc( view );
+			check += doc.size();
+		}
+	} );
+
+	bson::document_t doc;
+	doc.deserialize( view );
+	bson::compact_document compact( view );
+
+	double doc_traverse = measure( 5, [&]()
+	{
+		for( int i = 0; i < repeat * 10; i++ )
+		{
+			for( const auto & it : doc )
+			{
+				if( auto val = std::get_if< bson::int32_t >( &it.second ) )
+				{
+					check += static_cast<std::int32_t>( *val );
+				}
+			}
+		}
+	} );
+	double compact_traverse = measure( 5, [&]()
+	{
+		for( int i = 0; i < repeat * 10; i++ )
+		{
+			for( const auto & it : compact )
+			{
+				if( it.type == bson::element_type::int32_node )
+				{
+					check += it.int32;
+				}
+			}
+		}
+	} );
+
+	double doc_encode = measure( 5, [&]()
+	{
+		for( int i = 0; i < repeat; i++ )
+		{
+			std::vector<char> buf;
+			doc.serialize_to( buf );
+			check += buf.size();
+		}
+	} );
+	double compact_encode = measure( 5, [&]()
+	{
+		for( int i = 0; i < repeat; i++ )
+		{
+			std::vector<char> buf;
+			compact.serialize_to( buf );
+			check += buf.size();
+		}
+	} );
+
+	std::cout << "decode x" << repeat << ":       document_t " << doc_decode << " ms, compact_document " << compact_decode << " ms" << std::endl;
+	std::cout << "traverse x" << repeat * 10 << ":    document_t " << doc_traverse << " ms, compact_document " << compact_traverse << " ms" << std::endl;
+	std::cout << "serialize x" << repeat << ":    document_t " << doc_encode << " ms, compact_document " << compact_encode << " ms" << std::endl;
+	std::cout << "(" << check << ")" << std::endl;
+
+	return 0;
+}
@@ -0,0 +1,148 @@
+#include <chrono>
+#include <random>
+#include <string>
+#include <sstream>
+#include <iostream>
+
+#include "../bson.hpp"
+
+// best of several rounds, one slow round from the scheduler should not decide the result
+template< typename F > static double measure( int rounds, F && func )
+{
+	double best = 0;
+
+	for( int i = 0; i < rounds; i++ )
+	{
+		auto beg = std::chrono::steady_clock::now();
+		func();
+		auto end = std::chrono::steady_clock::now();
+
+		double ms = std::chrono::duration<double, std::milli>( end - beg ).count();
+		if( i == 0 || ms < best )
+		{
+			best = ms;
+		}
+	}
+
+	return best;
+}
+
+static void report( const char * name, double ms, std::size_t bytes )
+{
+	std::cout << name << ": " << ms << " ms, " << bytes / ( ms * 1000.0 ) << " MB/s" << std::endl;
+}
+
+static std::string make_document( std::mt19937 & rng )
+{
+	bson::document_t doc;
+
+	doc.insert( "_id", bson::object_id_t::generate() );
+	doc.insert( "name", bson::string_t( "user name number " + std::to_string( rng() % 100000 ) ) );
+	doc.insert( "age", bson::int32_t( static_cast<std::int32_t>( rng() % 100 ) ) );
+	doc.insert( "score", bson::double_t( ( rng() % 100000 ) / 7.0 ) );
+	doc.insert( "active", bson::boolean_t( rng() % 2 == 0 ) );
+	doc.insert( "created", bson::datetime_t( std::time_t( 1600000000000 + rng() % 100000000 ) ) );
+
+	bson::array_t tags;
+	for( std::size_t i = 0, n = rng() % 8; i < n; i++ )
+	{
+		tags.push_back( "tag" + std::to_string( rng() % 50 ) );
+	}
+	doc.insert( "tags", tags );
+
+	bson::document_t addr;
+	addr.insert( "street", bson::string_t( std::to_string( rng() % 1000 ) + " Main Street" ) );
+	addr.insert( "city", bson::string_t( "Springfield" ) );
+	addr.insert( "zip", bson::int32_t( static_cast<std::int32_t>( rng() % 100000 ) ) );
+	doc.insert( "addr", addr );
+
+	bson::array_t vals;
+	for( std::int32_t i = 0; i < 16; i++ )
+	{
+		vals.push_back( static_cast<std::int32_t>( rng() % 1000 ) );
+	}
+	doc.insert( "vals", vals );
+
+	std::stringstream ss;
+	doc.to_json( ss );
+
+	return ss.str();
+}
+
+int main()
+{
+	std::mt19937 rng( 42 );
+
+	std::vector< std::string > corpus;
+	std::size_t bytes = 0;
+	for( int i = 0; i < 20000; i++ )
+	{
+		corpus.push_back( make_document( rng ) );
+		bytes += corpus.back().size();
+	}
+
+	std::cout << corpus.size() << " documents, " << bytes << " bytes of JSON" << std::endl;
+
+	std::size_t check = 0;
+
+	double stream_ms = measure( 5, [&]()
+	{
+		for( const auto & text : corpus )
+		{
+			std::stringstream ss( text );
+			bson::document_t doc;
+			doc.from_json( ss );
+			check += doc.get_size();
+		}
+	} );
+	report( "document_t::from_json( std::istream & )", stream_ms, bytes );
+
+	double reader_ms = measure( 5, [&]()
+	{
+		for( const auto & text : corpus )
+		{
+			bson::json_reader reader( text );
+			bson::document_t doc;
+			doc.from_json( reader );
+			check += doc.get_size();
+		}
+	} );
+	report( "document_t::from_json( json_reader & )", reader_ms, bytes );
+
+	double direct_ms = measure( 5, [&]()
+	{
+		std::vector<char> out;
+		for( const auto & text : corpus )
+		{
+			out.clear();
+			bson::json_to_bson( std::string_view( text ), out );
+			check += out.size();
+		}
+	} );
+	report( "json_to_bson( std::string_view )", direct_ms, bytes );
+
+	// both front ends must build the same document
+	for( const auto & text : corpus )
+	{
+		std::stringstream ss( text );
+		bson::document_t a;
+		a.from_json( ss );
+
+		bson::json_reader reader( text );
+		bson::document_t b;
+		b.from_json( reader );
+
+		std::vector<char> x, y;
+		a.serialize_to( x );
+		b.serialize_to( y );
+		if( x != y )
+		{
+			std::cerr << "front ends disagree on " << text << std::endl;
+			return 1;
+		}
+	}
+
+	std::cout << "speedup over istream: json_reader " << stream_ms / reader_ms << "x, json_to_bson " << stream_ms / direct_ms << "x (" << check << ")" << std::endl;
+
+	return 0;
+}
@@ -0,0 +1,92 @@
+#include <chrono>
+#include <string>
+#include <sstream>
+#include <iostream>
+
+#include "../bson.hpp"
+
+// best of several rounds, one slow round from the scheduler should not decide the result
+template< typename F > static double measure( int rounds, F && func )
+{
+	double best = 0;
+
+	for( int i = 0; i < rounds; i++ )
+	{
+		auto beg = std::chrono::steady_clock::now();
+		func();
+		auto end = std::chrono::steady_clock::now();
+
+		double ms = std::chrono::duration<double, std::milli>( end - beg ).count();
+		if( i == 0 || ms < best )
+		{
+			best = ms;
+		}
+	}
+
+	return best;
+}
+
+static void report( const char * name, double ms, std::size_t bytes )
+{
+	std::cout << name << ": " << ms << " ms, " << bytes / ( ms * 1000.0 ) << " MB/s" << std::endl;
+}
+
+int main()
+{
+	// a large array of int32 is the worst case for the stream path, one os.write per scalar
+	bson::array_t ints;
+	for( std::int32_t i = 0; i < 100000; i++ )
+	{
+		ints.push_back( i );
+	}
+
+	bson::document_t doc;
+	doc.insert( "ints", ints );
+	for( int i = 0; i < 1000; i++ )
+	{
+		doc.insert( "str_" + std::to_string( i ), bson::string_t( "value string " + std::to_string( i ) ) );
+		doc.insert( "dbl_" + std::to_string( i ), bson::double_t( i * 0.5 ) );
+	}
+
+	const int repeat = 20;
+	const std::size_t size = doc.get_size();
+	std::size_t check = 0;
+
+	std::cout << "document of " << size << " bytes, " << repeat << " encodes per round" << std::endl;
+
+	double stream_ms = measure( 5, [&]()
+	{
+		for( int i = 0; i < repeat; i++ )
+		{
+			std::stringstream ss;
+			doc.serialize( ss );
+			check += ss.str().size();
+		}
+	} );
+	report( "serialize( std::stringstream & )", stream_ms, size * repeat );
+
+	double vector_ms = measure( 5, [&]()
+	{
+		for( int i = 0; i < repeat; i++ )
+		{
+			std::vector<char> buf;
+			doc.serialize_to( buf );
+			check += buf.size();
+		}
+	} );
+	report( "serialize_to( std::vector<char> & )", vector_ms, size * repeat );
+
+	std::vector<char> span( size );
+	double span_ms = measure( 5, [&]()
+	{
+		for( int i = 0; i < repeat; i++ )
+		{
+			check += doc.serialize_to( span.data(), span.size() );
+		}
+	} );
+	report( "serialize_to( char *, std::size_t )", span_ms, size * repeat );
+
+	std::cout << "speedup over stream: vector " << stream_ms / vector_ms << "x, span " << stream_ms / span_ms << "x (" << check << ")" << std::endl;
+
+	return 0;
+}
@@ -11,14 +11,50 @@
 #pragma once
 
 #include <array>
+#include <cmath>
+#include <ctime>
+#include <tuple>
+#include <mutex>
+#include <atomic>
+#include <random>
+#include <thread>
 #include <chrono>
 #include <limits>
 #include <string>
 #include <vector>
-#include <iomanip>
+#include <cstring>
+#include <fstream>
+#include <charconv>
 #include <variant>
 #include <sstream>
 #include <cassert>
+#include <iterator>
+#include <algorithm>
+#include <optional>
+#include <stdexcept>
+#include <string_view>
+#include <memory_resource>
+#include <condition_variable>
+
+#if defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 )
+#include <emmintrin.h>
+#define BSON_SSE2
+#endif
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+#ifdef WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <io.h>
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
 
 namespace bson
 {
@@ -56,17 +92,123 @@ namespace bson
 
 	template< element_type T > class element;
 
-	template< typename ... T > void create_node( element_type val, std::variant< T... > & node );
+	class value_view;
+	class document_view;
+	class array_view;
+
+	template< typename ... T > void create_node( element_type val, std::variant< T... > & node, std::pmr::memory_resource * resource = std::pmr::get_default_resource() );
 	template< typename ... T > element_type get_node_type( const std::variant< T... > & node );
 	template< typename ... T > std::size_t get_node_size( const std::variant< T... > & node );
-	template< typename ... T > void node_deserialize( std::istream & is, std::variant< T... > & node );
+	template< typename ... T > void node_deserialize( std::istream & is, std::variant< T... > & node, std::pmr::memory_resource * resource = std::pmr::get_default_resource() );
+	template< typename ... T > void node_deserialize( const value_view & val, std::variant< T... > & node, std::pmr::memory_resource * resource = std::pmr::get_default_resource() );
 	template< typename ... T > void node_serialize( std::ostream & os, const std::variant< T... > & node );
+	template< typename ... T > char * node_serialize( char * dst, const std::variant< T... > & node );
 	template< typename ... T > void node_to_json( std::ostream & os, const std::variant< T... > & node );
-	template< typename ... T > void node_from_json( std::istream & is, std::variant< T... > & node );
+	template< typename S, typename ... T > void node_from_json( S & is, std::variant< T... > & node, std::pmr::memory_resource * resource = std::pmr::get_default_resource() );
 
 	template< typename ... T > struct overloaded : T... { using T::operator()...; };
 	template< typename ... T > overloaded( T... )->overloaded< T... >;
 
+	template< typename ... T > struct is_memory_resource : std::false_type {};
+	template< typename T > struct is_memory_resource< T > : std::is_base_of< std::pmr::memory_resource, std::remove_pointer_t< std::decay_t< T > > > {};
+
+	class json_reader
+	{
+	public:
+		json_reader( const char * data, std::size_t size )
+			:beg( data ), cur( data ), end( data + size )
+		{
+
+		}
+
+		explicit json_reader( std::string_view json )
+			:json_reader( json.data(), json.size() )
+		{
+
+		}
+
+	public:
+		bool eof() const
+		{
+			return cur == end;
+		}
+
+		int peek() const
+		{
+			return cur != end ? static_cast<unsigned char>( *cur ) : std::char_traits<char>::eof();
+		}
+
+		int get()
+		{
+			return cur != end ? static_cast<unsigned char>( *cur++ ) : std::char_traits<char>::eof();
+		}
+
+		std::size_t tellg() const
+		{
+			return cur - beg;
+		}
+
+		void seekg( std::size_t pos )
+		{
+			cur = beg + pos;
+		}
+
+	public:
+		void skip_whitespace()
+		{
+			// single separators are the common case, only long runs of indentation go wide
+			if( cur == end || !is_whitespace( *cur ) )
+			{
+				return;
+			}
+
+#ifdef BSON_SSE2
+			while( end - cur >= 16 )
+			{
+				__m128i chunk = _mm_loadu_si128( reinterpret_cast<const __m128i *>( cur ) );
+				__m128i space = _mm_or_si128( _mm_cmpeq_epi8( chunk, _mm_set1_epi8( ' ' ) ), _mm_cmpeq_epi8( chunk, _mm_set1_epi8( '\t' ) ) );
+				__m128i lines = _mm_or_si128( _mm_cmpeq_epi8( chunk, _mm_set1_epi8( '\r' ) ), _mm_cmpeq_epi8( chunk, _mm_set1_epi8( '\n' ) ) );
+
+				if( _mm_movemask_epi8( _mm_or_si128( space, lines ) ) != 0xFFFF )
+				{
+					break;
+				}
+
+				cur += 16;
+			}
+#endif
+
+			while( cur != end && is_whitespace( *cur ) )
+			{
+				cur++;
+			}
+		}
+
+		std::string_view scan( char delim )
+		{
+			const char * pos = static_cast<const char *>( std::memchr( cur, delim, end - cur ) );
+			if( pos == nullptr )
+			{
+				pos = end;
+			}
+
+			std::string_view result( cur, pos - cur );
+
+			cur = pos;
+
+			return result;
+		}
+
+	private:
+		static bool is_whitespace( char c )
+		{
+			return c == ' ' || c == '\r' || c == '\n' || c == '\t';
+		}
+
+	private:
+		const char * beg, * cur, * end;
+	};
+
 	inline int sget( std::istream & is )
 	{
 		while( true )
@@ -84,6 +226,14 @@ namespace bson
 			}
 		}
 	}
+	inline int sget( json_reader & is )
+	{
+		is.skip_whitespace();
+
+		assert( !is.eof() && "inline int sget( json_reader & is )" );
+
+		return is.get();
+	}
 	inline int speek( std::istream & is )
 	{
 		while( true )
@@ -102,7 +252,15 @@ namespace bson
 			}
 		}
 	}
-	inline std::string sread( std::istream & is, std::size_t size )
+	inline int speek( json_reader & is )
+	{
+		is.skip_whitespace();
+
+		assert( !is.eof() && "inline int speek( json_reader & is )" );
+
+		return is.peek();
+	}
+	template< typename S > std::string sread( S & is, std::size_t size )
 	{
 		std::string result;
 
@@ -113,826 +271,1255 @@ namespace bson
 
 		return result;
 	}
-	inline bool smatch( std::istream & is, std::string_view delim )
+	template< typename S > bool smatch( S & is, std::string_view delim )
 	{
 		auto pos = is.tellg();
-		if( sread( is, delim.size() ) == delim )
+		for( char c : delim )
 		{
-			return true;
+			if( sget( is ) != static_cast<unsigned char>( c ) )
+			{
+				is.seekg( pos );
+				return false;
+			}
 		}
-		is.seekg( pos );
-		return false;
+		return true;
 	}
-
-
-	template<> class element< element_type::null_node >
+	template< typename String > void sappend( std::istream & is, char delim, String & str )
 	{
-	public:
-		element() = default;
-
-		element( std::nullptr_t )
+		while( is.peek() != delim && !is.eof() )
 		{
-
+			str.push_back( is.get() );
 		}
+	}
+	template< typename String > void sappend( json_reader & is, char delim, String & str )
+	{
+		auto view = is.scan( delim );
 
-		element & operator=( std::nullptr_t )
+		str.insert( str.end(), view.begin(), view.end() );
+	}
+	template< typename S > std::string_view snumber( S & is, char * buf, std::size_t size )
+	{
+		std::size_t len = 0;
+		for( int c = speek( is ); ( c >= '0' && c <= '9' ) || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E'; c = speek( is ) )
 		{
-			return *this;
+			if( len == size )
+			{
+				throw std::out_of_range( "template< typename S > std::string_view snumber( S & is, char * buf, std::size_t size )" );
+			}
+
+			buf[len++] = static_cast<char>( sget( is ) );
 		}
+		return { buf, len };
+	}
 
-		~element() = default;
+	template< typename T > T parse_number( std::string_view str )
+	{
+		T val = {};
 
-	public:
-		operator std::nullptr_t() const
+		auto result = std::from_chars( str.data(), str.data() + str.size(), val );
+		if( result.ec == std::errc::result_out_of_range )
 		{
-			return nullptr;
+			throw std::out_of_range( "template< typename T > T parse_number( std::string_view str )" );
 		}
-
-	public:
-		element_type get_type() const
+		if( result.ec != std::errc() || result.ptr != str.data() + str.size() )
 		{
-			return element_type::null_node;
+			throw std::runtime_error( "template< typename T > T parse_number( std::string_view str )" );
 		}
 
-		std::size_t get_size() const
-		{
-			return 0;
-		}
+		return val;
+	}
+	template< typename T > void write_number( std::ostream & os, T val )
+	{
+		char buf[32];
 
-		void serialize( std::ostream & ) const
+		auto result = std::to_chars( buf, buf + sizeof( buf ), val );
+
+		os.write( buf, result.ptr - buf );
+	}
+	inline char * format_double( char * dst, double val )
+	{
+		if( std::isnan( val ) )
 		{
+			std::memcpy( dst, "\"NaN\"", 5 );
 
+			return dst + 5;
 		}
-
-		void deserialize( std::istream & )
+		if( std::isinf( val ) )
 		{
+			if( val < 0 )
+			{
+				std::memcpy( dst, "\"-Infinity\"", 11 );
 
-		}
+				return dst + 11;
+			}
 
-	public:
-		void to_json( std::ostream & os ) const
-		{
-			os << "null";
-		}
+			std::memcpy( dst, "\"Infinity\"", 10 );
 
-		void from_json( std::istream & is )
-		{
-			assert( smatch( is, "null" ) && "void from_json( std::istream & is )" );
+			return dst + 10;
 		}
-	};
 
-	template<> class element< element_type::int32_node >
-	{
-	public:
-		element() = default;
+		char * end = std::to_chars( dst, dst + 30, val ).ptr;
 
-		element( std::int32_t val )
-			:value( val )
+		// keep integral values distinguishable from int32/int64 when read back
+		if( std::memchr( dst, '.', end - dst ) == nullptr && std::memchr( dst, 'e', end - dst ) == nullptr )
 		{
-
+			*end++ = '.';
+			*end++ = '0';
 		}
 
-		element & operator =( std::int32_t val )
-		{
-			value = val;
+		return end;
+	}
+	inline char * format_datetime( char * dst, std::time_t val )
+	{
+		// floor division, so pre-epoch values keep a positive millisecond part
+		struct tm _tm;
+		auto _tt = val / 1000 - ( val % 1000 < 0 ? 1 : 0 );
+		auto _ms = ( val % 1000 + 1000 ) % 1000;
 
-			return *this;
-		}
+#ifdef WIN32
+		gmtime_s( &_tm, &_tt );
+#else
+		gmtime_r( &_tt, &_tm );
+#endif // WIN32
 
-		~element() = default;
+		*dst++ = '\"';
+		dst += std::strftime( dst, 32, "%Y-%m-%dT%H:%M:%S", &_tm );
+		*dst++ = '.';
 
-	public:
-		operator std::int32_t() const
+		char buf[24];
+		char * end = std::to_chars( buf, buf + sizeof( buf ), _ms ).ptr;
+		for( auto i = end - buf; i < 3; i++ )
 		{
-			return value;
+			*dst++ = '0';
 		}
+		std::memcpy( dst, buf, end - buf );
+		dst += end - buf;
 
-		std::int32_t get_value() const
-		{
-			return value;
-		}
+		*dst++ = 'Z';
+		*dst++ = '\"';
 
-	public:
-		element_type get_type() const
-		{
-			return element_type::int32_node;
-		}
+		return dst;
+	}
+	inline std::time_t parse_datetime( std::string_view str )
+	{
+		// "YYYY-MM-DDTHH:MM:SS[.mmm]Z" in UTC, the inverse of format_datetime
+		static constexpr std::size_t offset[] = { 0, 5, 8, 11, 14, 17, 20 };
+		static constexpr std::size_t width[] = { 4, 2, 2, 2, 2, 2, 3 };
+		static constexpr char separator[] = "--T::.";
 
-		std::size_t get_size() const
+		std::size_t count = str.size() == 24 ? 7 : 6;
+		if( ( str.size() != 24 && str.size() != 20 ) || str.back() != 'Z' )
 		{
-			return sizeof( std::int32_t );
+			throw std::runtime_error( "inline std::time_t parse_datetime( std::string_view str )" );
 		}
 
-		void serialize( std::ostream & os ) const
+		std::int64_t field[7] = {};
+		for( std::size_t i = 0; i < count; i++ )
 		{
-			os.write( reinterpret_cast<const char *>( &value ), sizeof( value ) );
-		}
+			const char * beg = str.data() + offset[i];
 
-		void deserialize( std::istream & is )
-		{
-			is.read( reinterpret_cast<char *>( &value ), sizeof( value ) );
+			auto result = std::from_chars( beg, beg + width[i], field[i] );
+			if( result.ec != std::errc() || result.ptr != beg + width[i] || field[i] < 0 || ( i != 0 && beg[-1] != separator[i - 1] ) )
+			{
+				throw std::runtime_error( "inline std::time_t parse_datetime( std::string_view str )" );
+			}
 		}
-
-	public:
-		void to_json( std::ostream & os ) const
+		if( field[1] < 1 || field[1] > 12 || field[2] < 1 || field[2] > 31 || field[3] > 23 || field[4] > 59 || field[5] > 60 )
 		{
-			os << std::to_string( value );
+			throw std::runtime_error( "inline std::time_t parse_datetime( std::string_view str )" );
 		}
 
-		void from_json( std::istream & is )
-		{
-			std::string str;
-			if( speek( is ) == '-' )
-			{
-				str.push_back( sget( is ) );
-			}
-			while( speek( is ) >= '0' && speek( is ) <= '9' )
-			{
-				str.push_back( sget( is ) );
-			}
-			value = std::stoi( str );
-		}
+		// days since the epoch for a proleptic gregorian date
+		std::int64_t year = field[0] - ( field[1] <= 2 ? 1 : 0 );
+		std::int64_t era = ( year >= 0 ? year : year - 399 ) / 400;
+		std::int64_t yoe = year - era * 400;
+		std::int64_t doy = ( 153 * ( field[1] + ( field[1] > 2 ? -3 : 9 ) ) + 2 ) / 5 + field[2] - 1;
+		std::int64_t days = era * 146097 + yoe * 365 + yoe / 4 - yoe / 100 + doy - 719468;
 
-	private:
-		std::int32_t value;
-	};
+		return static_cast<std::time_t>( ( ( days * 24 + field[3] ) * 60 + field[4] ) * 60 + field[5] ) * 1000 + static_cast<std::time_t>( field[6] );
+	}
 
-	template<> class element< element_type::int64_node >
+	inline std::size_t base64_encode_size( std::size_t size )
 	{
-	public:
-		element() = default;
+		return ( size + 2 ) / 3 * 4;
+	}
+	inline std::size_t base64_decode_size( std::size_t size )
+	{
+		return ( size + 3 ) / 4 * 3;
+	}
+	inline char * base64_encode( char * dst, const char * data, std::size_t size )
+	{
+		static constexpr char encode_table[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
 
-		element( std::int64_t val )
-			:value( val )
+		const unsigned char * src = reinterpret_cast<const unsigned char *>( data );
+		const unsigned char * end = src + size;
+
+#ifdef __AVX2__
+		// 24 bytes in, 32 characters out; the upper lane reads 4 bytes past the block
+		while( end - src >= 28 )
 		{
+			__m256i in = _mm256_inserti128_si256( _mm256_castsi128_si256( _mm_loadu_si128( reinterpret_cast<const __m128i *>( src ) ) ), _mm_loadu_si128( reinterpret_cast<const __m128i *>( src + 12 ) ), 1 );
 
-		}
+			in = _mm256_shuffle_epi8( in, _mm256_setr_epi8( 1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10, 1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10 ) );
 
-		element & operator =( std::int64_t val )
-		{
-			value = val;
+			__m256i hi = _mm256_mulhi_epu16( _mm256_and_si256( in, _mm256_set1_epi32( 0x0fc0fc00 ) ), _mm256_set1_epi32( 0x04000040 ) );
+			__m256i lo = _mm256_mullo_epi16( _mm256_and_si256( in, _mm256_set1_epi32( 0x003f03f0 ) ), _mm256_set1_epi32( 0x01000010 ) );
+			__m256i indices = _mm256_or_si256( hi, lo );
 
-			return *this;
-		}
+			__m256i range = _mm256_subs_epu8( indices, _mm256_set1_epi8( 51 ) );
+			range = _mm256_or_si256( range, _mm256_and_si256( _mm256_cmpgt_epi8( _mm256_set1_epi8( 26 ), indices ), _mm256_set1_epi8( 13 ) ) );
 
-		~element() = default;
+			__m256i offset = _mm256_shuffle_epi8( _mm256_setr_epi8(
+				'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0,
+				'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0 ), range );
 
-	public:
-		operator std::int64_t() const
-		{
-			return value;
+			_mm256_storeu_si256( reinterpret_cast<__m256i *>( dst ), _mm256_add_epi8( offset, indices ) );
+
+			src += 24;
+			dst += 32;
 		}
+#endif
 
-		std::int64_t get_value() const
+		while( end - src >= 3 )
 		{
-			return value;
+			*dst++ = encode_table[src[0] >> 2];
+			*dst++ = encode_table[( ( src[0] & 0x03 ) << 4 ) | ( src[1] >> 4 )];
+			*dst++ = encode_table[( ( src[1] & 0x0f ) << 2 ) | ( src[2] >> 6 )];
+			*dst++ = encode_table[src[2] & 0x3f];
+
+			src += 3;
 		}
 
-	public:
-		element_type get_type() const
+		if( end - src == 1 )
 		{
-			return element_type::int64_node;
+			*dst++ = encode_table[src[0] >> 2];
+			*dst++ = encode_table[( src[0] & 0x03 ) << 4];
+			*dst++ = '=';
+			*dst++ = '=';
 		}
-
-		std::size_t get_size() const
+		else if( end - src == 2 )
 		{
-			return sizeof( std::int64_t );
+			*dst++ = encode_table[src[0] >> 2];
+			*dst++ = encode_table[( ( src[0] & 0x03 ) << 4 ) | ( src[1] >> 4 )];
+			*dst++ = encode_table[( src[1] & 0x0f ) << 2];
+			*dst++ = '=';
 		}
 
-		void serialize( std::ostream & os ) const
-		{
-			os.write( reinterpret_cast<const char *>( &value ), sizeof( value ) );
+		return dst;
+	}
+	inline char * base64_decode( char * dst, const char * data, std::size_t size )
+	{
+		static constexpr signed char decode_table[] =
+		{
+			-2, -2, -2, -2, -2, -2, -2, -2, -2, -1, -1, -2, -2, -1, -2, -2,
+			-2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2,
+			-1, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, 62, -2, -2, -2, 63,
+			52, 53, 54, 55, 56, 57, 58, 59, 60, 61, -2, -2, -2, -2, -2, -2,
+			-2,  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14,
+			15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, -2, -2, -2, -2, -2,
+			-2, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40,
+			41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, -2, -2, -2, -2, -2,
+			-2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2,
+			-2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2,
+			-2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2,
+			-2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2,
+			-2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2,
+			-2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2,
+			-2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2,
+			-2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2
+		};
+
+		const unsigned char * src = reinterpret_cast<const unsigned char *>( data );
+		const unsigned char * end = src + size;
+
+#ifdef __AVX2__
+		// 32 characters in, 24 bytes out; blocks holding '=', whitespace or junk go scalar
+		while( end - src >= 32 )
+		{
+			__m256i in = _mm256_loadu_si256( reinterpret_cast<const __m256i *>( src ) );
+			__m256i hi_nibbles = _mm256_and_si256( _mm256_srli_epi32( in, 4 ), _mm256_set1_epi8( 0x0f ) );
+			__m256i lo_nibbles = _mm256_and_si256( in, _mm256_set1_epi8( 0x0f ) );
+
+			__m256i lo = _mm256_shuffle_epi8( _mm256_setr_epi8(
+				0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A,
+				0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A ), lo_nibbles );
+			__m256i hi = _mm256_shuffle_epi8( _mm256_setr_epi8(
+				0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+				0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10 ), hi_nibbles );
+			if( !_mm256_testz_si256( lo, hi ) )
+			{
+				break;
+			}
+
+			__m256i roll = _mm256_shuffle_epi8( _mm256_setr_epi8(
+				0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0,
+				0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0 ), _mm256_add_epi8( _mm256_cmpeq_epi8( in, _mm256_set1_epi8( '/' ) ), hi_nibbles ) );
+			__m256i values = _mm256_add_epi8( in, roll );
+
+			__m256i merged = _mm256_madd_epi16( _mm256_maddubs_epi16( values, _mm256_set1_epi32( 0x01400140 ) ), _mm256_set1_epi32( 0x00011000 ) );
+			__m256i packed = _mm256_shuffle_epi8( merged, _mm256_setr_epi8(
+				2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+				2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1 ) );
+
+			char buf[32];
+			_mm256_storeu_si256( reinterpret_cast<__m256i *>( buf ), packed );
+			std::memcpy( dst, buf, 12 );
+			std::memcpy( dst + 12, buf + 16, 12 );
+
+			src += 32;
+			dst += 24;
 		}
+#endif
 
-		void deserialize( std::istream & is )
+		int bits = 0, count = 0;
+		for( ; src != end && *src != '='; src++ )
 		{
-			is.read( reinterpret_cast<char *>( &value ), sizeof( value ) );
+			int ch = decode_table[*src];
+			if( ch < 0 )
+			{
+				continue;
+			}
+
+			bits = ( bits << 6 ) | ch;
+			if( ++count == 4 )
+			{
+				*dst++ = static_cast<char>( bits >> 16 );
+				*dst++ = static_cast<char>( bits >> 8 );
+				*dst++ = static_cast<char>( bits );
+				bits = 0;
+				count = 0;
+			}
 		}
 
-	public:
-		void to_json( std::ostream & os ) const
+		if( count == 2 )
+		{
+			*dst++ = static_cast<char>( bits >> 4 );
+		}
+		else if( count == 3 )
 		{
-			os << std::to_string( value );
+			*dst++ = static_cast<char>( bits >> 10 );
+			*dst++ = static_cast<char>( bits >> 2 );
 		}
 
-		void from_json( std::istream & is )
+		return dst;
+	}
+
+	struct hex_table
+	{
+		signed char values[256] = {};
+
+		constexpr hex_table()
 		{
-			std::string str;
-			if( speek( is ) == '-' )
+			for( int i = 0; i < 256; i++ )
+			{
+				values[i] = -1;
+			}
+			for( int i = 0; i < 10; i++ )
 			{
-				str.push_back( sget( is ) );
+				values['0' + i] = static_cast<signed char>( i );
 			}
-			while( speek( is ) >= '0' && speek( is ) <= '9' )
+			for( int i = 0; i < 6; i++ )
 			{
-				str.push_back( sget( is ) );
+				values['a' + i] = values['A' + i] = static_cast<signed char>( 10 + i );
 			}
-			value = std::stoll( str );
 		}
-
-	private:
-		std::int64_t value;
 	};
-
-	template<> class element< element_type::double_node >
+	inline char * hex_encode( char * dst, const char * data, std::size_t size )
 	{
-	public:
-		element() = default;
+		static constexpr char encode_table[] = "0123456789abcdef";
 
-		element( double val )
-			:value( val )
+		for( std::size_t i = 0; i < size; i++ )
 		{
+			unsigned char c = static_cast<unsigned char>( data[i] );
 
+			*dst++ = encode_table[c >> 4];
+			*dst++ = encode_table[c & 0x0f];
 		}
 
-		element( const element< element_type::double_node > & val )
-			:value( val.value )
+		return dst;
+	}
+	inline char * hex_decode( char * dst, const char * data, std::size_t size )
+	{
+		static constexpr hex_table decode_table;
+
+		for( std::size_t i = 0; i + 1 < size; i += 2 )
 		{
+			int hi = decode_table.values[static_cast<unsigned char>( data[i] )];
+			int lo = decode_table.values[static_cast<unsigned char>( data[i + 1] )];
+			if( ( hi | lo ) < 0 )
+			{
+				throw std::runtime_error( "inline char * hex_decode( char * dst, const char * data, std::size_t size )" );
+			}
 
+			*dst++ = static_cast<char>( ( hi << 4 ) | lo );
 		}
 
-		element & operator =( double val )
-		{
-			value = val;
+		return dst;
+	}
 
-			return *this;
-		}
-
-		element & operator =( const element< element_type::double_node > & val )
-		{
-			value = val.value;
-
-			return *this;
-		}
-
-		~element() = default;
-
-	public:
-		operator double() const
-		{
-			return value;
-		}
-
-		double get_value() const
+	template< typename T > T raw_load( const char * data )
+	{
+		T val;
+		std::memcpy( &val, data, sizeof( T ) );
+		return val;
+	}
+	template< typename T > char * raw_store( char * dst, const T & val )
+	{
+		std::memcpy( dst, &val, sizeof( T ) );
+		return dst + sizeof( T );
+	}
+	template< typename C > void pmr_swap( C & a, C & b )
+	{
+		// polymorphic allocators never propagate on swap, so containers from different resources trade contents by moving
+		if( a.get_allocator() == b.get_allocator() )
 		{
-			return value;
+			a.swap( b );
 		}
-
-	public:
-		element_type get_type() const
+		else
 		{
-			return element_type::double_node;
+			C temp( std::move( a ), a.get_allocator() );
+			a = std::move( b );
+			b = std::move( temp );
 		}
+	}
+	inline std::size_t raw_size( element_type type, const char * data, std::size_t size )
+	{
+		std::size_t result = 0;
 
-		std::size_t get_size() const
+		switch( type )
 		{
-			return sizeof( double );
-		}
-
-		void serialize( std::ostream & os ) const
+		case element_type::null_node:
+		case element_type::min_key_node:
+		case element_type::max_key_node:
+			result = 0;
+			break;
+		case element_type::boolean_node:
+			result = 1;
+			break;
+		case element_type::int32_node:
+			result = sizeof( std::int32_t );
+			break;
+		case element_type::int64_node:
+		case element_type::double_node:
+		case element_type::datetime_node:
+		case element_type::timestamp_node:
+			result = sizeof( std::int64_t );
+			break;
+		case element_type::object_id_node:
+			result = 12;
+			break;
+		case element_type::string_node:
+		case element_type::binary_node:
+		case element_type::array_node:
+		case element_type::document_node:
 		{
-			os.write( reinterpret_cast<const char *>( &value ), sizeof( value ) );
-		}
+			if( size < sizeof( std::int32_t ) )
+			{
+				throw std::out_of_range( "inline std::size_t raw_size( element_type type, const char * data, std::size_t size )" );
+			}
 
-		void deserialize( std::istream & is )
-		{
-			is.read( reinterpret_cast<char *>( &value ), sizeof( value ) );
-		}
+			// a string keeps at least its terminator, a document or array its length and terminator
+			std::int32_t sz = raw_load< std::int32_t >( data );
+			if( sz < ( type == element_type::string_node ? 1 : type == element_type::binary_node ? 0 : 5 ) )
+			{
+				throw std::out_of_range( "inline std::size_t raw_size( element_type type, const char * data, std::size_t size )" );
+			}
 
-	public:
-		void to_json( std::ostream & os ) const
-		{
-			if( std::isnan( value ) )
+			if( type == element_type::string_node )
 			{
-				os << "\"NaN\"";
+				result = sizeof( std::int32_t ) + sz;
 			}
-			else if( std::isinf( value ) )
+			else if( type == element_type::binary_node )
 			{
-				os << "\"" << ( value < 0 ? "-" : "" ) << "Infinity" << "\"";
+				result = sizeof( std::int32_t ) + 1 + sz;
 			}
 			else
 			{
-				os << std::to_string( value );
+				result = sz;
 			}
 		}
-
-		void from_json( std::istream & is )
+		break;
+		case element_type::regular_node:
 		{
-			if( sget( is ) == '\"' )
+			auto pattern = static_cast<const char *>( std::memchr( data, 0, size ) );
+			if( pattern == nullptr )
 			{
-				bool neg = false;
-
-				if( speek( is ) == '-' )
-				{
-					neg = true;
-				}
-
-				if( speek( is ) == 'N' )
-				{
-					smatch( is, "NaN" );
-
-					value = std::numeric_limits< double >::quiet_NaN();
-				}
-				else if( speek( is ) == 'I' )
-				{
-					smatch( is, "Infinity" );
-
-					value = neg ? -std::numeric_limits< double >::infinity() : std::numeric_limits< double >::infinity();
-				}
-
-				assert( sget( is ) == '\"' && "void from_json( std::istream & is )" );
+				throw std::out_of_range( "inline std::size_t raw_size( element_type type, const char * data, std::size_t size )" );
 			}
-			else
+
+			auto options = static_cast<const char *>( std::memchr( pattern + 1, 0, size - ( pattern + 1 - data ) ) );
+			if( options == nullptr )
 			{
-				std::string str;
-				while( ( speek( is ) >= '0' && speek( is ) <= '9' ) || speek( is ) == '.' )
-				{
-					str.push_back( sget( is ) );
-				}
-				value = std::stod( str );
+				throw std::out_of_range( "inline std::size_t raw_size( element_type type, const char * data, std::size_t size )" );
 			}
-		}
-
-	private:
-		double value;
-	};
-
-	template<> class element< element_type::string_node >
-	{
-	public:
-		element() = default;
 
-		element( element< element_type::string_node > && val )
-		{
-			swap( std::forward<element< element_type::string_node >>( val ) );
+			result = options + 1 - data;
+		}
+		break;
+		default:
+			throw std::runtime_error( "bson::type unknown" );
+			break;
 		}
 
-		element( const element< element_type::string_node > & val )
-			:value( val.value )
+		if( result > size )
 		{
-
+			throw std::out_of_range( "inline std::size_t raw_size( element_type type, const char * data, std::size_t size )" );
 		}
 
-		element( std::string && val )
+		if( ( type == element_type::string_node || type == element_type::array_node || type == element_type::document_node ) && data[result - 1] != 0 )
 		{
-			std::swap( value, val );
+			throw std::out_of_range( "inline std::size_t raw_size( element_type type, const char * data, std::size_t size )" );
 		}
 
-		element( const std::string & val )
-			:value( val )
+		return result;
+	}
+	inline std::vector< std::uint64_t > split_documents( const char * data, std::size_t size )
+	{
+		std::vector< std::uint64_t > result;
+
+		for( std::size_t pos = 0; pos < size; )
 		{
+			if( size - pos < 5 )
+			{
+				throw std::out_of_range( "inline std::vector< std::uint64_t > split_documents( const char * data, std::size_t size )" );
+			}
 
-		}
+			std::int32_t sz = raw_load< std::int32_t >( data + pos );
+			if( sz < 5 || static_cast<std::size_t>( sz ) > size - pos )
+			{
+				throw std::out_of_range( "inline std::vector< std::uint64_t > split_documents( const char * data, std::size_t size )" );
+			}
 
-		element & operator =( element< element_type::string_node > && val )
-		{
-			swap( std::forward<element< element_type::string_node >>( val ) );
+			result.push_back( pos );
 
-			return *this;
+			pos += static_cast<std::size_t>( sz );
 		}
 
-		element & operator =( const element< element_type::string_node > & val )
-		{
-			value = val.value;
+		return result;
+	}
 
-			return *this;
-		}
+	struct array_key_table
+	{
+		char keys[1000][4] = {};
 
-		element & operator =( std::string && val )
+		constexpr array_key_table()
 		{
-			std::swap( value, val );
-
-			return *this;
+			for( std::size_t i = 0; i < 1000; i++ )
+			{
+				std::size_t n = 0;
+				if( i >= 100 )
+				{
+					keys[i][n++] = static_cast<char>( '0' + i / 100 );
+				}
+				if( i >= 10 )
+				{
+					keys[i][n++] = static_cast<char>( '0' + i / 10 % 10 );
+				}
+				keys[i][n++] = static_cast<char>( '0' + i % 10 );
+			}
 		}
+	};
+	inline std::string_view array_key( std::size_t i, char * buf )
+	{
+		static constexpr array_key_table table;
 
-		element & operator =( const std::string & val )
+		if( i < 1000 )
 		{
-			value = val;
-
-			return *this;
+			return { table.keys[i], static_cast<std::size_t>( i < 10 ? 1 : i < 100 ? 2 : 3 ) };
 		}
 
-		~element() = default;
+		auto result = std::to_chars( buf, buf + 20, i );
 
-	public:
-		void swap( element< element_type::string_node > & val )
+		return { buf, static_cast<std::size_t>( result.ptr - buf ) };
+	}
+	inline std::size_t array_keys_size( std::size_t count )
+	{
+		// type byte, decimal index and terminator of every array element
+		std::size_t result = 2 * count;
+		for( std::size_t lo = 0, hi = 10, digits = 1; lo < count; lo = hi, hi *= 10, digits++ )
 		{
-			std::swap( value, val.value );
+			result += ( ( count < hi ? count : hi ) - lo ) * digits;
 		}
+		return result;
+	}
 
+	class value_view
+	{
 	public:
-		operator const std::string & ( ) const
-		{
-			return value;
-		}
+		value_view() = default;
 
-		const std::string & get_value() const
+		value_view( element_type type, const char * data, std::size_t size )
+			:type( type ), data( data ), size( size )
 		{
-			return value;
+
 		}
 
 	public:
 		element_type get_type() const
 		{
-			return element_type::string_node;
+			return type;
 		}
 
-		std::size_t get_size() const
+		const char * get_data() const
 		{
-			return sizeof( std::int32_t ) + value.size() + 1;
+			return data;
 		}
 
-		void serialize( std::ostream & os ) const
+		std::size_t get_size() const
 		{
-			std::int32_t sz = static_cast<std::int32_t>( value.size() + 1 );
-
-			os.write( reinterpret_cast<const char *>( &sz ), sizeof( sz ) );
-
-			os.write( value.c_str(), value.size() + 1 );
+			return size;
 		}
 
-		void deserialize( std::istream & is )
+	public:
+		std::int32_t get_int32() const
 		{
-			std::int32_t sz;
-
-			is.read( reinterpret_cast<char *>( &sz ), sizeof( sz ) );
-
-			value.resize( sz - 1 );
+			assert( type == element_type::int32_node && "std::int32_t get_int32() const" );
 
-			is.read( value.data(), sz );
+			return raw_load< std::int32_t >( data );
 		}
 
-	public:
-		void to_json( std::ostream & os ) const
+		std::int64_t get_int64() const
 		{
-			os << ( "\"" + value + "\"" );
+			assert( type == element_type::int64_node && "std::int64_t get_int64() const" );
+
+			return raw_load< std::int64_t >( data );
 		}
 
-		void from_json( std::istream & is )
+		double get_double() const
 		{
-			if( sget( is ) == '\"' )
-			{
-				while( is.peek() != '\"' )
-				{
-					value.push_back( is.get() );
-				}
+			assert( type == element_type::double_node && "double get_double() const" );
 
-				assert( sget( is ) == '\"' && "void from_json( std::istream & is )" );
-			}
+			return raw_load< double >( data );
 		}
 
-	private:
-		std::string value;
-	};
-
-	template<> class element< element_type::binary_node >
-	{
-	public:
-		element() = default;
-
-		template< typename T > element( const T & container, binary_type type = binary_type::binary )
-			:btype( type )
+		std::string_view get_string() const
 		{
-			value.insert( value.end(), container.begin(), container.end() );
+			assert( type == element_type::string_node && "std::string_view get_string() const" );
+
+			return { data + sizeof( std::int32_t ), size - sizeof( std::int32_t ) - 1 };
 		}
 
-		element( element< element_type::binary_node > && val )
+		binary_type get_binary_type() const
 		{
-			swap( std::forward<element< element_type::binary_node >>( val ) );
+			assert( type == element_type::binary_node && "binary_type get_binary_type() const" );
+
+			return static_cast<binary_type>( data[sizeof( std::int32_t )] );
 		}
 
-		element( const element< element_type::binary_node > & val )
-			:btype( val.btype ), value( val.value )
+		std::string_view get_binary() const
 		{
+			assert( type == element_type::binary_node && "std::string_view get_binary() const" );
 
+			return { data + sizeof( std::int32_t ) + 1, size - sizeof( std::int32_t ) - 1 };
 		}
 
-		element & operator =( element< element_type::binary_node > && val )
+		bool get_boolean() const
 		{
-			swap( std::forward<element< element_type::binary_node >>( val ) );
+			assert( type == element_type::boolean_node && "bool get_boolean() const" );
 
-			return *this;
+			return data[0] == 1;
 		}
 
-		element & operator =( const element< element_type::binary_node > & val )
+		std::string_view get_pattern() const
 		{
-			btype = val.btype;
-			value = val.value;
+			assert( type == element_type::regular_node && "std::string_view get_pattern() const" );
 
-			return *this;
+			return { data };
 		}
 
-		~element() = default;
-
-	public:
-		void swap( element< element_type::binary_node > & val )
+		std::string_view get_options() const
 		{
-			std::swap( btype, val.btype );
-			std::swap( value, val.value );
+			assert( type == element_type::regular_node && "std::string_view get_options() const" );
+
+			return { data + get_pattern().size() + 1 };
 		}
 
-	public:
-		const std::vector<char> & get_value() const
+		std::time_t get_datetime() const
 		{
-			return value;
+			assert( type == element_type::datetime_node && "std::time_t get_datetime() const" );
+
+			return static_cast<std::time_t>( raw_load< std::int64_t >( data ) );
 		}
 
-	public:
-		element_type get_type() const
+		std::uint64_t get_timestamp() const
 		{
-			return element_type::binary_node;
+			assert( type == element_type::timestamp_node && "std::uint64_t get_timestamp() const" );
+
+			return raw_load< std::uint64_t >( data );
 		}
 
-		std::size_t get_size() const
+		std::array<char, 12> get_object_id() const
 		{
-			return value.size() + 5;
+			assert( type == element_type::object_id_node && "std::array<char, 12> get_object_id() const" );
+
+			std::array<char, 12> result;
+			std::memcpy( result.data(), data, result.size() );
+			return result;
 		}
 
-		void serialize( std::ostream & os ) const
-		{
-			std::int32_t sz = static_cast<std::int32_t>( value.size() );
+		document_view get_document() const;
 
-			os.write( reinterpret_cast<const char *>( &sz ), sizeof( sz ) );
+		array_view get_array() const;
 
-			os.write( reinterpret_cast<const char *>( &btype ), sizeof( btype ) );
+	private:
+		element_type type = element_type::unknown_node;
+		const char * data = nullptr;
+		std::size_t size = 0;
+	};
 
-			os.write( reinterpret_cast<const char *>( value.data() ), value.size() );
-		}
+	class document_view
+	{
+	public:
+		using value_type = std::pair< std::string_view, value_view >;
 
-		void deserialize( std::istream & is )
+		class const_iterator
 		{
-			std::int32_t sz;
+		public:
+			using iterator_category = std::forward_iterator_tag;
+			using value_type = std::pair< std::string_view, value_view >;
+			using difference_type = std::ptrdiff_t;
+			using pointer = const value_type *;
+			using reference = const value_type &;
 
-			is.read( reinterpret_cast<char *>( &sz ), sizeof( sz ) );
+		public:
+			const_iterator() = default;
 
-			is.read( reinterpret_cast<char *>( &btype ), sizeof( btype ) );
+			const_iterator( const char * cur, const char * end )
+				:cur( cur ), end( end )
+			{
+				load();
+			}
 
-			value.resize( static_cast<std::size_t>( sz ) );
-			is.read( reinterpret_cast<char *>( value.data() ), static_cast< std::size_t >( sz ) );
-		}
+		public:
+			reference operator*() const
+			{
+				return value;
+			}
 
-	public:
-		void to_json( std::ostream & os ) const
-		{
-			static constexpr std::string_view encode_table = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+			pointer operator->() const
+			{
+				return &value;
+			}
 
-			std::string encode;
+			const_iterator & operator++()
+			{
+				cur = value.second.get_data() + value.second.get_size();
 
-			std::size_t bytes = value.size();
-			const char * current = value.data();
+				load();
 
-			while( bytes > 2 )
+				return *this;
+			}
+
+			const_iterator operator++( int )
 			{
-				encode += encode_table[current[0] >> 2];
-				encode += encode_table[( ( current[0] & 0x03 ) << 4 ) + ( current[1] >> 4 )];
-				encode += encode_table[( ( current[1] & 0x0f ) << 2 ) + ( current[2] >> 6 )];
-				encode += encode_table[current[2] & 0x3f];
+				auto result = *this;
 
-				current += 3;
-				bytes -= 3;
+				++( *this );
+
+				return result;
 			}
-			if( bytes > 0 )
+
+			bool operator==( const const_iterator & val ) const
 			{
-				encode += encode_table[current[0] >> 2];
-				if( bytes % 3 == 1 )
-				{
-					encode += encode_table[( current[0] & 0x03 ) << 4];
-					encode += "==";
-				}
-				else if( bytes % 3 == 2 )
-				{
-					encode += encode_table[( ( current[0] & 0x03 ) << 4 ) + ( current[1] >> 4 )];
-					encode += encode_table[( current[1] & 0x0f ) << 2];
-					encode += "=";
-				}
+				return cur == val.cur;
 			}
 
-			os << R"({ "base64" : ")" << encode << R"(", "subType" : ")" << std::to_string( (std::uint8_t)btype ) << "\" }";
-		}
-
-		void from_json( std::istream & is )
-		{
-			constexpr char decode_table[] =
+			bool operator!=( const const_iterator & val ) const
 			{
-				-2, -2, -2, -2, -2, -2, -2, -2, -2, -1, -1, -2, -2, -1, -2, -2,
-				-2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2,
-				-1, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, 62, -2, -2, -2, 63,
-				52, 53, 54, 55, 56, 57, 58, 59, 60, 61, -2, -2, -2, -2, -2, -2,
-				-2,  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14,
-				15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, -2, -2, -2, -2, -2,
-				-2, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40,
-				41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, -2, -2, -2, -2, -2,
-				-2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2,
-				-2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2,
-				-2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2,
-				-2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2,
-				-2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2,
-				-2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2,
-				-2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2,
-				-2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2, -2
-			};
+				return cur != val.cur;
+			}
 
-			std::string encode;
-			if( smatch( is, R"({"base64":")" ) )
+		private:
+			void load()
 			{
-				while( is.peek() != '\"' )
+				if( cur == end )
 				{
-					encode.push_back( is.get() );
+					return;
 				}
 
-				if( smatch( is, R"(","subType":")" ) )
-				{
-					std::string subt;
-					while( speek( is ) != '\"' )
-					{
-						subt.push_back( is.get() );
-					}
+				element_type t = static_cast<element_type>( *cur );
 
-					assert( smatch( is, "\"}" ) && "void from_json( std::istream & is )" );
+				const char * key = cur + 1;
+				auto term = static_cast<const char *>( std::memchr( key, 0, end - key ) );
+				if( term == nullptr )
+				{
+					throw std::out_of_range( "void document_view::const_iterator::load()" );
+				}
 
-					{
-						int bin = 0, i = 0;
-						auto length = encode.size();
-						const char * current = encode.c_str();
-						char ch;
-						while( ( ch = *current++ ) != '\0' && length-- > 0 )
-						{
-							if( ch == '=' )
-							{
-								if( *current != '=' && ( i % 4 ) == 1 )
-								{
-									return;
-								}
-								continue;
-							}
-							ch = decode_table[ch];
-							if( ch < 0 )
-							{
-								continue;
-							}
-							switch( i % 4 )
-							{
-							case 0:
-								bin = ch << 2;
-								break;
-							case 1:
-								bin |= ch >> 4;
-								value.push_back( bin );
-								bin = ( ch & 0x0f ) << 4;
-								break;
-							case 2:
-								bin |= ch >> 2;
-								value.push_back( bin );
-								bin = ( ch & 0x03 ) << 6;
-								break;
-							case 3:
-								bin |= ch;
-								value.push_back( bin );
-								break;
-							}
-							i++;
-						}
-					}
+				const char * data = term + 1;
 
-					btype = static_cast<binary_type>( std::stoi( subt, nullptr, 16 ) );
-				}
+				value = { std::string_view( key, term - key ), value_view( t, data, raw_size( t, data, end - data ) ) };
 			}
-		}
 
-	private:
-		binary_type btype = binary_type::binary;
-		std::vector< char > value;
-	};
+		private:
+			const char * cur = nullptr;
+			const char * end = nullptr;
+			value_type value;
+		};
 
-	template<> class element< element_type::boolean_node >
-	{
 	public:
-		element() = default;
+		document_view() = default;
 
-		element( bool val )
-			:value( val )
+		document_view( const char * data, std::size_t size )
+			:data( data )
 		{
+			if( size < 5 )
+			{
+				throw std::out_of_range( "document_view( const char * data, std::size_t size )" );
+			}
 
+			std::int32_t sz = raw_load< std::int32_t >( data );
+			if( sz < 5 || static_cast<std::size_t>( sz ) > size || data[sz - 1] != 0 )
+			{
+				throw std::out_of_range( "document_view( const char * data, std::size_t size )" );
+			}
+
+			this->size = static_cast<std::size_t>( sz );
 		}
 
-		element( const element< element_type::boolean_node > & val )
-			:value( val.value )
+		document_view( std::string_view val )
+			:document_view( val.data(), val.size() )
 		{
 
 		}
 
-		element & operator =( bool val )
+	public:
+		const char * get_data() const
 		{
-			value = val;
+			return data;
+		}
 
-			return *this;
+		std::size_t get_size() const
+		{
+			return size;
 		}
 
-		~element() = default;
+		bool empty() const
+		{
+			return size <= 5;
+		}
 
 	public:
-		operator bool() const
+		const_iterator begin() const
 		{
-			return value;
+			if( data == nullptr )
+			{
+				return {};
+			}
+
+			return { data + sizeof( std::int32_t ), data + size - 1 };
 		}
 
-		bool get_value() const
+		const_iterator end() const
 		{
-			return value;
+			if( data == nullptr )
+			{
+				return {};
+			}
+
+			return { data + size - 1, data + size - 1 };
 		}
 
 	public:
-		element_type get_type() const
+		const_iterator find( std::string_view key ) const
 		{
-			return element_type::boolean_node;
+			for( auto it = begin(); it != end(); ++it )
+			{
+				if( it->first == key )
+				{
+					return it;
+				}
+			}
+
+			return end();
 		}
 
-		std::size_t get_size() const
+		value_view operator[]( std::string_view key ) const
 		{
-			return 1;
+			auto it = find( key );
+			if( it != end() )
+			{
+				return it->second;
+			}
+
+			throw std::out_of_range( "value_view operator[]( std::string_view key ) const" );
 		}
 
-		void serialize( std::ostream & os ) const
+	private:
+		const char * data = nullptr;
+		std::size_t size = 0;
+	};
+
+	class array_view : public document_view
+	{
+	public:
+		using document_view::document_view;
+
+	public:
+		value_view operator[]( std::size_t i ) const
 		{
-			char c = value ? 1 : 0;
+			for( auto it = begin(); it != end(); ++it, --i )
+			{
+				if( i == 0 )
+				{
+					return it->second;
+				}
+			}
 
-			os.write( &c, 1 );
+			throw std::out_of_range( "value_view operator[]( std::size_t i ) const" );
 		}
+	};
 
-		void deserialize( std::istream & is )
-		{
-			char c;
+	inline document_view value_view::get_document() const
+	{
+		assert( type == element_type::document_node && "document_view get_document() const" );
 
-			is.read( &c, 1 );
+		return { data, size };
+	}
 
-			value = c == 1;
-		}
+	inline array_view value_view::get_array() const
+	{
+		assert( type == element_type::array_node && "array_view get_array() const" );
+
+		return { data, size };
+	}
 
+	// default callbacks for parse(), handlers derive and hide the ones they need;
+	// returning false from on_key or on_start_* skips that value or subtree
+	class parse_handler
+	{
 	public:
-		void to_json( std::ostream & os ) const
+		bool on_key( std::string_view ) { return true; }
+		void on_null() {}
+		void on_int32( std::int32_t ) {}
+		void on_int64( std::int64_t ) {}
+		void on_double( double ) {}
+		void on_string( std::string_view ) {}
+		void on_binary( std::string_view, binary_type ) {}
+		void on_boolean( bool ) {}
+		void on_min_key() {}
+		void on_max_key() {}
+		void on_regular( std::string_view, std::string_view ) {}
+		void on_datetime( std::time_t ) {}
+		void on_timestamp( std::uint64_t ) {}
+		void on_object_id( const std::array<char, 12> & ) {}
+		bool on_start_document() { return true; }
+		void on_end_document() {}
+		bool on_start_array() { return true; }
+		void on_end_array() {}
+	};
+
+	template< typename Handler > void parse( const document_view & doc, Handler & handler );
+
+	template< typename Handler > void parse_value( const value_view & val, Handler & handler )
+	{
+		switch( val.get_type() )
 		{
-			os << ( value ? "true" : "false" );
-		}
+		case element_type::null_node:
+			handler.on_null();
+			break;
+		case element_type::int32_node:
+			handler.on_int32( val.get_int32() );
+			break;
+		case element_type::int64_node:
+			handler.on_int64( val.get_int64() );
+			break;
+		case element_type::double_node:
+			handler.on_double( val.get_double() );
+			break;
+		case element_type::string_node:
+			handler.on_string( val.get_string() );
+			break;
+		case element_type::binary_node:
+			handler.on_binary( val.get_binary(), val.get_binary_type() );
+			break;
+		case element_type::boolean_node:
+			handler.on_boolean( val.get_boolean() );
+			break;
+		case element_type::min_key_node:
+			handler.on_min_key();
+			break;
+		case element_type::max_key_node:
+			handler.on_max_key();
+			break;
+		case element_type::regular_node:
+			handler.on_regular( val.get_pattern(), val.get_options() );
+			break;
+		case element_type::datetime_node:
+			handler.on_datetime( val.get_datetime() );
+			break;
+		case element_type::timestamp_node:
+			handler.on_timestamp( val.get_timestamp() );
+			break;
+		case element_type::object_id_node:
+			handler.on_object_id( val.get_object_id() );
+			break;
+		case element_type::document_node:
+			parse( val.get_document(), handler );
+			break;
+		case element_type::array_node:
+			if( handler.on_start_array() )
+			{
+				for( const auto & it : val.get_array() )
+				{
+					if( handler.on_key( it.first ) )
+					{
+						parse_value( it.second, handler );
+					}
+				}
 
-		void from_json( std::istream & is )
+				handler.on_end_array();
+			}
+			break;
+		default:
+			throw std::runtime_error( "bson::type unknown" );
+		}
+	}
+	template< typename Handler > void parse( const document_view & doc, Handler & handler )
+	{
+		if( handler.on_start_document() )
 		{
-			value = speek( is ) == 't' ? smatch( is, "true" ) : !smatch( is, "false" );
+			for( const auto & it : doc )
+			{
+				if( handler.on_key( it.first ) )
+				{
+					parse_value( it.second, handler );
+				}
+			}
+
+			handler.on_end_document();
 		}
+	}
+	template< typename Handler > void parse( const char * data, std::size_t size, Handler & handler )
+	{
+		parse( document_view( data, size ), handler );
+	}
 
-	private:
-		bool value;
-	};
+	inline void bson_to_json( const document_view & doc, std::string & out );
+	inline void bson_to_json( const array_view & arr, std::string & out );
 
-	template<> class element< element_type::min_key_node >
+	// same text as node_to_json, written from the raw bytes without decoding into nodes
+	inline void bson_to_json( const value_view & val, std::string & out )
 	{
-	public:
-		element() = default;
+		char buf[64];
 
-		element( std::nullptr_t )
+		switch( val.get_type() )
+		{
+		case element_type::null_node:
+			out.append( "null" );
+			break;
+		case element_type::int32_node:
+			out.append( buf, std::to_chars( buf, buf + sizeof( buf ), val.get_int32() ).ptr - buf );
+			break;
+		case element_type::int64_node:
+			out.append( buf, std::to_chars( buf, buf + sizeof( buf ), val.get_int64() ).ptr - buf );
+			break;
+		case element_type::double_node:
+			out.append( buf, format_double( buf, val.get_double() ) - buf );
+			break;
+		case element_type::string_node:
+			out.push_back( '\"' );
+			out.append( val.get_string() );
+			out.push_back( '\"' );
+			break;
+		case element_type::binary_node:
 		{
+			auto bin = val.get_binary();
+
+			out.append( R"({ "$binary" : { "base64" : ")" );
 
+			std::size_t pos = out.size();
+			out.resize( pos + base64_encode_size( bin.size() ) );
+			base64_encode( out.data() + pos, bin.data(), bin.size() );
+
+			// extended json writes the subtype as two hex digits
+			char sub = static_cast<char>( val.get_binary_type() );
+			out.append( R"(", "subType" : ")" );
+			out.append( buf, hex_encode( buf, &sub, 1 ) - buf );
+			out.append( "\" } }" );
 		}
+		break;
+		case element_type::boolean_node:
+			out.append( val.get_boolean() ? "true" : "false" );
+			break;
+		case element_type::min_key_node:
+			out.append( R"({ "$minKey" : 1 })" );
+			break;
+		case element_type::max_key_node:
+			out.append( R"({ "$maxKey" : 1 })" );
+			break;
+		case element_type::regular_node:
+			out.append( R"({ "$regularExpression" : { "pattern" : ")" );
+			out.append( val.get_pattern() );
+			out.append( R"(", "options" : ")" );
+			out.append( val.get_options() );
+			out.append( "\" } }" );
+			break;
+		case element_type::datetime_node:
+			out.append( R"({ "$date" : )" );
+			out.append( buf, format_datetime( buf, val.get_datetime() ) - buf );
+			out.append( " }" );
+			break;
+		case element_type::timestamp_node:
+			out.append( R"({ "$timestamp" : { "t" : )" );
+			out.append( buf, std::to_chars( buf, buf + sizeof( buf ), val.get_timestamp() ).ptr - buf );
+			out.append( R"(, "i" : 1 } })" );
+			break;
+		case element_type::object_id_node:
+		{
+			auto oid = val.get_object_id();
 
-		element & operator=( std::nullptr_t )
+			out.append( R"({ "$oid" : ")" );
+			out.append( buf, hex_encode( buf, oid.data(), oid.size() ) - buf );
+			out.append( "\" }" );
+		}
+		break;
+		case element_type::document_node:
+			bson_to_json( val.get_document(), out );
+			break;
+		case element_type::array_node:
+			bson_to_json( val.get_array(), out );
+			break;
+		default:
+			throw std::runtime_error( "bson::type unknown" );
+		}
+	}
+	inline void bson_to_json( const document_view & doc, std::string & out )
+	{
+		out.append( "{ " );
 		{
-			return *this;
+			bool first = true;
+			for( const auto & it : doc )
+			{
+				if( !first )
+				{
+					out.append( ", " );
+				}
+				first = false;
+
+				out.push_back( '\"' );
+				out.append( it.first );
+				out.append( "\" : " );
+
+				bson_to_json( it.second, out );
+			}
 		}
+		out.append( " }" );
+	}
+	inline void bson_to_json( const array_view & arr, std::string & out )
+	{
+		out.append( "[ " );
+		{
+			bool first = true;
+			for( const auto & it : arr )
+			{
+				if( !first )
+				{
+					out.append( ", " );
+				}
+				first = false;
 
-		~element() = default;
+				bson_to_json( it.second, out );
+			}
+		}
+		out.append( " ]" );
+	}
+	inline void bson_to_json( const char * data, std::size_t size, std::string & out )
+	{
+		bson_to_json( document_view( data, size ), out );
+	}
 
+	// trie of dotted paths, a path that ends on a node selects its whole subtree
+	class projection
+	{
 	public:
-		element_type get_type() const
+		static constexpr std::size_t npos = static_cast<std::size_t>( -1 );
+
+	public:
+		projection()
+			:nodes( 1 )
 		{
-			return element_type::min_key_node;
+
 		}
 
-		std::size_t get_size() const
+		projection( std::initializer_list< std::string_view > paths )
+			:nodes( 1 )
 		{
-			return 0;
+			for( auto path : paths )
+			{
+				add( path );
+			}
 		}
 
-		void serialize( std::ostream & ) const
+	public:
+		void add( std::string_view path )
 		{
+			std::size_t cur = 0;
 
+			while( !nodes[cur].leaf )
+			{
+				auto pos = path.find( '.' );
+				auto key = path.substr( 0, pos );
+
+				std::size_t next = find( cur, key );
+				if( next == npos )
+				{
+					next = nodes.size();
+
+					nodes[cur].children.push_back( next );
+					nodes.emplace_back().key = key;
+				}
+
+				cur = next;
+
+				if( pos == std::string_view::npos )
+				{
+					nodes[cur].leaf = true;
+					nodes[cur].children.clear();
+				}
+				else
+				{
+					path.remove_prefix( pos + 1 );
+				}
+			}
 		}
 
-		void deserialize( std::istream & )
+		std::size_t find( std::size_t node, std::string_view key ) const
 		{
+			for( auto it : nodes[node].children )
+			{
+				if( nodes[it].key == key )
+				{
+					return it;
+				}
+			}
 
+			return npos;
 		}
 
-	public:
-		void to_json( std::ostream & os ) const
+		bool is_leaf( std::size_t node ) const
 		{
-			os << 1;
+			return nodes[node].leaf;
 		}
 
-		void from_json( std::istream & is )
+		bool empty() const
 		{
-			assert( smatch( is, "1" ) && "void from_json( std::istream & is )" );
+			return nodes.size() == 1;
 		}
+
+	private:
+		struct node
+		{
+			std::string key;
+			bool leaf = false;
+			std::vector< std::size_t > children;
+		};
+
+		std::vector< node > nodes;
 	};
 
-	template<> class element< element_type::max_key_node >
+
+	template<> class element< element_type::null_node >
 	{
 	public:
 		element() = default;
@@ -949,10 +1536,16 @@ namespace bson
 
 		~element() = default;
 
+	public:
+		operator std::nullptr_t() const
+		{
+			return nullptr;
+		}
+
 	public:
 		element_type get_type() const
 		{
-			return element_type::max_key_node;
+			return element_type::null_node;
 		}
 
 		std::size_t get_size() const
@@ -965,6 +1558,11 @@ namespace bson
 
 		}
 
+		char * serialize( char * dst ) const
+		{
+			return dst;
+		}
+
 		void deserialize( std::istream & )
 		{
 
@@ -973,162 +1571,104 @@ namespace bson
 	public:
 		void to_json( std::ostream & os ) const
 		{
-			os << 1;
+			os << "null";
 		}
 
-		void from_json( std::istream & is )
+		template< typename S > void from_json( S & is )
 		{
-			assert( smatch( is, "1" ) && "void from_json( std::istream & is )" );
+			if( !smatch( is, "null" ) )
+			{
+				throw std::runtime_error( "template< typename S > void from_json( S & is )" );
+			}
 		}
 	};
 
-	template<> class element< element_type::regular_node >
+	template<> class element< element_type::int32_node >
 	{
 	public:
 		element() = default;
 
-		element( const std::string & pattern, const std::string & options )
-			:pattern( pattern ), options( options )
+		element( std::int32_t val )
+			:value( val )
 		{
 
 		}
 
-		element( element< element_type::regular_node > && val )
-		{
-			swap( std::forward<element< element_type::regular_node >>( val ) );
-		}
-
-		element( const element< element_type::regular_node > & val )
-			:pattern( val.pattern ), options( val.options )
+		element & operator =( std::int32_t val )
 		{
+			value = val;
 
-		}
-
-		element & operator =( element< element_type::regular_node > && val )
-		{
-			swap( std::forward<element< element_type::regular_node >>( val ) );
-			return *this;
-		}
-
-		element & operator =( const element< element_type::regular_node > & val )
-		{
-			pattern = val.pattern;
-			options = val.options;
-			return *this;
+			return *this;
 		}
 
 		~element() = default;
 
 	public:
-		void swap( element<element_type::regular_node> & val )
-		{
-			std::swap( pattern, val.pattern );
-			std::swap( options, val.options );
-		}
-
-		const std::string get_pattern() const
+		operator std::int32_t() const
 		{
-			return pattern;
+			return value;
 		}
 
-		const std::string get_options() const
+		std::int32_t get_value() const
 		{
-			return options;
+			return value;
 		}
 
 	public:
 		element_type get_type() const
 		{
-			return element_type::regular_node;
+			return element_type::int32_node;
 		}
 
 		std::size_t get_size() const
 		{
-			return pattern.size() + options.size() + 2;
+			return sizeof( std::int32_t );
 		}
 
 		void serialize( std::ostream & os ) const
 		{
-			os.write( pattern.c_str(), pattern.size() + 1 );
-			os.write( options.c_str(), options.size() + 1 );
+			os.write( reinterpret_cast<const char *>( &value ), sizeof( value ) );
 		}
 
-		void deserialize( std::istream & is )
+		char * serialize( char * dst ) const
 		{
-			while( !is.eof() )
-			{
-				char c = sget( is );
-
-				if( c == 0 )
-				{
-					break;
-				}
-
-				pattern.push_back( c );
-			}
-
-			while( !is.eof() )
-			{
-				char c = sget( is );
-
-				if( c == 0 )
-				{
-					break;
-				}
+			return raw_store( dst, value );
+		}
 
-				options.push_back( c );
-			}
+		void deserialize( std::istream & is )
+		{
+			is.read( reinterpret_cast<char *>( &value ), sizeof( value ) );
 		}
 
 	public:
 		void to_json( std::ostream & os ) const
 		{
-			os << R"({ "pattern" : ")" + pattern + R"(", "options" : ")" + options + "\" }";
+			write_number( os, value );
 		}
 
-		void from_json( std::istream & is )
+		template< typename S > void from_json( S & is )
 		{
-			if( smatch( is, R"({"pattern":")" ) )
-			{
-				while( is.peek() != '\"' )
-				{
-					pattern.push_back( is.get() );
-				}
-			}
-
-			if( smatch( is, R"(","options":")" ) )
-			{
-				while( is.peek() != '\"' )
-				{
-					options.push_back( is.get() );
-				}
-			}
+			char buf[32];
 
-			assert( smatch( is, "\"}" ) && "void from_json( std::istream & is )" );
+			value = parse_number< std::int32_t >( snumber( is, buf, sizeof( buf ) ) );
 		}
 
 	private:
-		std::string pattern, options;
+		std::int32_t value;
 	};
 
-	template<> class element< element_type::datetime_node >
+	template<> class element< element_type::int64_node >
 	{
 	public:
 		element() = default;
 
-		element( std::time_t val )
+		element( std::int64_t val )
 			:value( val )
 		{
 
 		}
 
-		element( const element< element_type::datetime_node > & val )
-			:value( val.value )
-		{
-
-		}
-
-		element & operator =( bool val )
+		element & operator =( std::int64_t val )
 		{
 			value = val;
 
@@ -1138,12 +1678,12 @@ namespace bson
 		~element() = default;
 
 	public:
-		operator std::time_t() const
+		operator std::int64_t() const
 		{
 			return value;
 		}
 
-		std::time_t get_value() const
+		std::int64_t get_value() const
 		{
 			return value;
 		}
@@ -1151,12 +1691,12 @@ namespace bson
 	public:
 		element_type get_type() const
 		{
-			return element_type::datetime_node;
+			return element_type::int64_node;
 		}
 
 		std::size_t get_size() const
 		{
-			return sizeof( value );
+			return sizeof( std::int64_t );
 		}
 
 		void serialize( std::ostream & os ) const
@@ -1164,6 +1704,11 @@ namespace bson
 			os.write( reinterpret_cast<const char *>( &value ), sizeof( value ) );
 		}
 
+		char * serialize( char * dst ) const
+		{
+			return raw_store( dst, value );
+		}
+
 		void deserialize( std::istream & is )
 		{
 			is.read( reinterpret_cast<char *>( &value ), sizeof( value ) );
@@ -1172,65 +1717,47 @@ namespace bson
 	public:
 		void to_json( std::ostream & os ) const
 		{
-			struct tm _tm;
-			auto _tt = value / 1000;
-
-#ifdef WIN32
-			gmtime_s( &_tm, &_tt );
-#else
-			gmtime_r( &_tt, &_tm );
-#endif // WIN32
-
-			os << "\"" << std::put_time( &_tm, "%Y-%m-%dT%H:%M:%S" ) << "." << std::setfill( '0' ) << std::setw( 3 ) << ( value % 1000 ) << "Z\"";
+			write_number( os, value );
 		}
 
-		void from_json( std::istream & is )
+		template< typename S > void from_json( S & is )
 		{
-			assert( smatch( is, "\"" ) && "void from_json( std::istream & is )" );
-			{
-				std::string date_t = sread( is, 24 );
-
-				struct tm _tm; std::int32_t millsec;
-
-				sscanf_s( date_t.c_str(), "%4d-%2d-%2dT%2d:%2d:%2d.%3dZ", &_tm.tm_year, &_tm.tm_mon, &_tm.tm_mday, &_tm.tm_hour, &_tm.tm_min, &_tm.tm_sec, &millsec );
-
-				_tm.tm_year -= 1900;
-				_tm.tm_mon -= 1;
+			char buf[32];
 
-				value = mktime( &_tm ) * 1000 + millsec;
-			}
-			assert( smatch( is, "\"" ) && "void from_json( std::istream & is )" );
+			value = parse_number< std::int64_t >( snumber( is, buf, sizeof( buf ) ) );
 		}
 
 	private:
-		std::time_t value = 0;
+		std::int64_t value;
 	};
 
-	template<> class element< element_type::timestamp_node >
+	template<> class element< element_type::double_node >
 	{
 	public:
 		element() = default;
 
-		element( std::uint64_t val )
+		element( double val )
 			:value( val )
 		{
 
 		}
 
-		template< typename ... T > element( const std::chrono::time_point< T... > & val )
+		element( const element< element_type::double_node > & val ) noexcept
+			:value( val.value )
 		{
-			value = std::chrono::duration_cast<std::chrono::milliseconds>( val ).count();
+
 		}
 
-		element( const element< element_type::timestamp_node > & val )
-			:value( val.value )
+		element & operator =( double val )
 		{
+			value = val;
 
+			return *this;
 		}
 
-		element & operator =( bool val )
+		element & operator =( const element< element_type::double_node > & val )
 		{
-			value = val;
+			value = val.value;
 
 			return *this;
 		}
@@ -1238,12 +1765,12 @@ namespace bson
 		~element() = default;
 
 	public:
-		operator std::uint64_t() const
+		operator double() const
 		{
 			return value;
 		}
 
-		std::uint64_t get_value() const
+		double get_value() const
 		{
 			return value;
 		}
@@ -1251,12 +1778,12 @@ namespace bson
 	public:
 		element_type get_type() const
 		{
-			return element_type::timestamp_node;
+			return element_type::double_node;
 		}
 
 		std::size_t get_size() const
 		{
-			return sizeof( value );
+			return sizeof( double );
 		}
 
 		void serialize( std::ostream & os ) const
@@ -1264,6 +1791,11 @@ namespace bson
 			os.write( reinterpret_cast<const char *>( &value ), sizeof( value ) );
 		}
 
+		char * serialize( char * dst ) const
+		{
+			return raw_store( dst, value );
+		}
+
 		void deserialize( std::istream & is )
 		{
 			is.read( reinterpret_cast<char *>( &value ), sizeof( value ) );
@@ -1272,72 +1804,97 @@ namespace bson
 	public:
 		void to_json( std::ostream & os ) const
 		{
-			os << R"({ "t" : )" << std::to_string( value ) << R"(, "i" : 1 })";
+			char buf[32];
+
+			os.write( buf, format_double( buf, value ) - buf );
 		}
 
-		void from_json( std::istream & is )
+		template< typename S > void from_json( S & is )
 		{
-			assert( smatch( is, R"({"t":)" ) && "void from_json( std::istream & is )" );
+			if( sget( is ) == '\"' )
 			{
-				std::string str;
-				while( speek( is ) >= '0' && speek( is ) <= '9' )
+				bool neg = false;
+
+				if( speek( is ) == '-' )
+				{
+					neg = true;
+					sget( is );
+				}
+
+				if( speek( is ) == 'N' )
+				{
+					smatch( is, "NaN" );
+
+					value = std::numeric_limits< double >::quiet_NaN();
+				}
+				else if( speek( is ) == 'I' )
+				{
+					smatch( is, "Infinity" );
+
+					value = neg ? -std::numeric_limits< double >::infinity() : std::numeric_limits< double >::infinity();
+				}
+
+				if( sget( is ) != '\"' )
 				{
-					str.push_back( sget( is ) );
+					throw std::runtime_error( "template< typename S > void from_json( S & is )" );
 				}
-				value = std::stoull( str );
 			}
-			assert( smatch( is, R"(,"i":1})" ) && "void from_json( std::istream & is )" );
+			else
+			{
+				char buf[64];
+
+				value = parse_number< double >( snumber( is, buf, sizeof( buf ) ) );
+			}
 		}
 
 	private:
-		std::uint64_t value = 0;
+		double value;
 	};
 
-	template<> class element< element_type::object_id_node >
+	template<> class element< element_type::string_node >
 	{
 	public:
 		element() = default;
 
-		element( element< element_type::object_id_node > && val )
+		explicit element( std::pmr::memory_resource * resource )
+			:value( resource )
 		{
-			swap( std::forward<element< element_type::object_id_node >>( val ) );
+
 		}
 
-		element( const element< element_type::object_id_node > & val )
-			:value( val.value )
+		element( element< element_type::string_node > && val ) noexcept
+			:value( std::move( val.value ) )
 		{
 
 		}
 
-		element( std::string_view val )
+		element( const element< element_type::string_node > & val )
+			:value( val.value )
 		{
-			for( size_t i = 0; i < value.size(); i++ )
-			{
-				value[i] = std::stoi( std::string( val.begin() + ( i * 2 ), val.begin() + ( i * 2 ) + 2 ), nullptr, 16 );
-			}
+
 		}
 
-		element( const std::array<char, 12> & val )
-			:value( val )
+		element( std::string_view val, std::pmr::memory_resource * resource = std::pmr::get_default_resource() )
+			:value( val, resource )
 		{
 
 		}
 
-		element & operator =( element< element_type::object_id_node > && val )
+		element & operator =( element< element_type::string_node > && val )
 		{
-			swap( std::forward<element< element_type::object_id_node >>( val ) );
+			value = std::move( val.value );
 
 			return *this;
 		}
 
-		element & operator =( const element< element_type::object_id_node > & val )
+		element & operator =( const element< element_type::string_node > & val )
 		{
 			value = val.value;
 
 			return *this;
 		}
 
-		element & operator =( const std::array<char, 12> & val )
+		element & operator =( std::string_view val )
 		{
 			value = val;
 
@@ -1347,18 +1904,18 @@ namespace bson
 		~element() = default;
 
 	public:
-		void swap( element< element_type::object_id_node > & val )
+		void swap( element< element_type::string_node > & val )
 		{
-			std::swap( value, val.value );
+			pmr_swap( value, val.value );
 		}
 
 	public:
-		operator const std::array<char, 12> & ( ) const
+		operator std::string_view() const
 		{
 			return value;
 		}
 
-		const std::array<char, 12> & get_value() const
+		std::string_view get_value() const
 		{
 			return value;
 		}
@@ -1366,110 +1923,107 @@ namespace bson
 	public:
 		element_type get_type() const
 		{
-			return element_type::object_id_node;
+			return element_type::string_node;
 		}
 
 		std::size_t get_size() const
 		{
-			return 12;
+			return sizeof( std::int32_t ) + value.size() + 1;
 		}
 
 		void serialize( std::ostream & os ) const
 		{
-			os.write( value.data(), 12 );
+			std::int32_t sz = static_cast<std::int32_t>( value.size() + 1 );
+
+			os.write( reinterpret_cast<const char *>( &sz ), sizeof( sz ) );
+
+			os.write( value.c_str(), value.size() + 1 );
+		}
+
+		char * serialize( char * dst ) const
+		{
+			dst = raw_store( dst, static_cast<std::int32_t>( value.size() + 1 ) );
+
+			std::memcpy( dst, value.c_str(), value.size() + 1 );
+
+			return dst + value.size() + 1;
 		}
 
 		void deserialize( std::istream & is )
 		{
-			is.read( value.data(), 12 );
+			std::int32_t sz;
+
+			is.read( reinterpret_cast<char *>( &sz ), sizeof( sz ) );
+
+			value.resize( sz - 1 );
+
+			is.read( value.data(), sz );
 		}
 
 	public:
 		void to_json( std::ostream & os ) const
 		{
-			os << "\"";
-			for( auto c : value )
-			{
-				os << std::setfill( '0' ) << std::setw( 2 ) << std::hex << static_cast<std::uint32_t>( static_cast<std::uint8_t>( c ) );
-			}
-			os << "\"";
+			os << ( "\"" + value + "\"" );
 		}
 
-		void from_json( std::istream & is )
+		template< typename S > void from_json( S & is )
 		{
-			assert( smatch( is, "\"" ) && "void from_json( std::istream & is )" );
+			if( sget( is ) == '\"' )
 			{
-				std::string hex;
-				for( size_t i = 0; i < value.size(); i++ )
+				sappend( is, '\"', value );
+
+				if( sget( is ) != '\"' )
 				{
-					hex.push_back( is.get() ); hex.push_back( is.get() );
-					value[i] = std::stoi( hex, nullptr, 16 );
-					hex.clear();
+					throw std::runtime_error( "template< typename S > void from_json( S & is )" );
 				}
 			}
-			assert( smatch( is, "\"" ) && "void from_json( std::istream & is )" );
 		}
 
 	private:
-		std::array<char, 12> value;
+		std::pmr::string value;
 	};
 
-	template< element_type T > class element
+	template<> class element< element_type::binary_node >
 	{
 	public:
-		using node_t = std::variant< std::monostate,
-			element< element_type::null_node >,
-			element< element_type::int32_node >,
-			element< element_type::int64_node >,
-			element< element_type::array_node >,
-			element< element_type::double_node >,
-			element< element_type::string_node >,
-			element< element_type::binary_node >,
-			element< element_type::boolean_node >,
-			element< element_type::min_key_node >,
-			element< element_type::max_key_node >,
-			element< element_type::regular_node >,
-			element< element_type::datetime_node >,
-			element< element_type::document_node >,
-			element< element_type::timestamp_node >,
-			element< element_type::object_id_node >
-		>;
+		element() = default;
 
-	public:
-		using value_type = node_t;
-		using mapped_type = std::pair< std::string, node_t >;
-		using iterator = std::vector< mapped_type >::iterator;
-		using const_iterator = std::vector< mapped_type >::const_iterator;
+		explicit element( std::pmr::memory_resource * resource )
+			:value( resource )
+		{
 
-	public:
-		element() = default;
+		}
 
-		template< typename ... T > element( T &&... args )
+		template< typename T > element( const T & container, binary_type type = binary_type::binary, std::pmr::memory_resource * resource = std::pmr::get_default_resource() )
+			:btype( type ), value( resource )
 		{
-			unpack( args... );
+			value.insert( value.end(), container.begin(), container.end() );
 		}
 
-		element( element<T> && val )
+		element( element< element_type::binary_node > && val ) noexcept
+			:btype( val.btype ), value( std::move( val.value ) )
 		{
-			swap( std::forward<element>( val ) );
+
 		}
 
-		element( const element<T> & val )
-			:nodes( val.nodes )
+		element( const element< element_type::binary_node > & val )
+			:btype( val.btype ), value( val.value )
 		{
 
 		}
 
-		element & operator =( element<T> && val )
+		element & operator =( element< element_type::binary_node > && val )
 		{
-			swap( std::forward<element<T>>( val ) );
+			btype = val.btype;
+			value = std::move( val.value );
 
 			return *this;
 		}
 
-		element & operator =( const element<T> & val )
+		element & operator =( const element< element_type::binary_node > & val )
 		{
-			nodes = val.nodes;
+			btype = val.btype;
+			value = val.value;
 
 			return *this;
 		}
@@ -1477,574 +2031,1914 @@ namespace bson
 		~element() = default;
 
 	public:
-		void swap( element<T> & val )
+		void swap( element< element_type::binary_node > & val )
 		{
-			std::swap( nodes, val.nodes );
+			std::swap( btype, val.btype );
+			pmr_swap( value, val.value );
 		}
 
 	public:
-		value_type & operator[]( std::size_t i )
+		const std::pmr::vector<char> & get_value() const
 		{
-			assert( get_type() == element_type::array_node && "element_list< type::array_node >" );
-
-			return nodes[i].second;
+			return value;
 		}
 
-		const value_type & operator[]( std::size_t i ) const
-		{
-			assert( get_type() == element_type::array_node && "element_list< type::array_node >" );
+	public:
+		element_type get_type() const
+		{
+			return element_type::binary_node;
+		}
 
-			return nodes[i].second;
+		std::size_t get_size() const
+		{
+			return value.size() + 5;
 		}
 
-		value_type & operator[]( const std::string & key )
+		void serialize( std::ostream & os ) const
 		{
-			assert( get_type() == element_type::array_node && "element_list< type::document_node >" );
+			std::int32_t sz = static_cast<std::int32_t>( value.size() );
 
-			auto it = std::find_if( begin(), end(), [&]( const auto & it ) { return it.first == key; } );
-			if( it != end() )
-			{
-				return it->second;
-			}
+			os.write( reinterpret_cast<const char *>( &sz ), sizeof( sz ) );
 
-			nodes.push_back( { key, value_type{} } );
+			os.write( reinterpret_cast<const char *>( &btype ), sizeof( btype ) );
 
-			return nodes.back().second;
+			os.write( reinterpret_cast<const char *>( value.data() ), value.size() );
 		}
 
-		const value_type & operator[]( const std::string & key ) const
+		char * serialize( char * dst ) const
 		{
-			assert( get_type() == element_type::array_node && "element_list< type::document_node >" );
+			dst = raw_store( dst, static_cast<std::int32_t>( value.size() ) );
 
-			auto it = std::find_if( begin(), end(), [&]( const auto & it ) { return it.first == key; } );
-			if( it != end() )
-			{
-				return it->second;
-			}
+			dst = raw_store( dst, btype );
 
-			throw std::out_of_range( "const value_type & operator[]( const std::string & key ) const" );
+			std::memcpy( dst, value.data(), value.size() );
+
+			return dst + value.size();
 		}
 
-	public:
-		bool empty() const
+		void deserialize( std::istream & is )
 		{
-			return nodes.empty();
+			std::int32_t sz;
+
+			is.read( reinterpret_cast<char *>( &sz ), sizeof( sz ) );
+
+			is.read( reinterpret_cast<char *>( &btype ), sizeof( btype ) );
+
+			value.resize( static_cast<std::size_t>( sz ) );
+			is.read( reinterpret_cast<char *>( value.data() ), static_cast< std::size_t >( sz ) );
 		}
 
 	public:
-		iterator begin()
+		void to_json( std::ostream & os ) const
 		{
-			return nodes.begin();
+			os << R"({ "base64" : ")";
+			{
+				char buf[4096];
+
+				for( std::size_t i = 0; i < value.size(); i += 3072 )
+				{
+					char * end = base64_encode( buf, value.data() + i, value.size() - i < 3072 ? value.size() - i : 3072 );
+
+					os.write( buf, end - buf );
+				}
+			}
+			char sub[2], type = static_cast<char>( btype );
+			hex_encode( sub, &type, 1 );
+
+			os << R"(", "subType" : ")";
+			os.write( sub, sizeof( sub ) );
+			os << "\" }";
 		}
 
-		iterator end()
+		template< typename S > void from_json( S & is )
 		{
-			return nodes.end();
+			std::string encode;
+			if( smatch( is, R"({"base64":")" ) )
+			{
+				sappend( is, '\"', encode );
+
+				if( smatch( is, R"(","subType":")" ) )
+				{
+					std::string subt;
+					while( speek( is ) != '\"' )
+					{
+						subt.push_back( is.get() );
+					}
+
+					if( !smatch( is, "\"}" ) )
+					{
+						throw std::runtime_error( "template< typename S > void from_json( S & is )" );
+					}
+
+					value.resize( base64_decode_size( encode.size() ) );
+					value.resize( base64_decode( value.data(), encode.data(), encode.size() ) - value.data() );
+
+					btype = static_cast<binary_type>( std::stoi( subt, nullptr, 16 ) );
+				}
+			}
 		}
 
-		const_iterator begin() const
+	private:
+		binary_type btype = binary_type::binary;
+		std::pmr::vector< char > value;
+	};
+
+	template<> class element< element_type::boolean_node >
+	{
+	public:
+		element() = default;
+
+		element( bool val )
+			:value( val )
 		{
-			return nodes.begin();
+
 		}
 
-		const_iterator end() const
+		element( const element< element_type::boolean_node > & val ) noexcept
+			:value( val.value )
 		{
-			return nodes.end();
+
+		}
+
+		element & operator =( bool val )
+		{
+			value = val;
+
+			return *this;
 		}
 
+		~element() = default;
+
 	public:
-		iterator find( const std::string & key )
+		operator bool() const
 		{
-			return std::find_if( begin(), end(), [&]( const auto & it ) { return it.first == key; } );
+			return value;
 		}
 
-		const_iterator find( const std::string & key ) const
+		bool get_value() const
 		{
-			return std::find_if( begin(), end(), [&]( const auto & it ) { return it.first == key; } );
+			return value;
 		}
 
 	public:
-		void erase( const_iterator val )
+		element_type get_type() const
 		{
-			nodes.erase( val );
+			return element_type::boolean_node;
+		}
 
-			if( T == element_type::array_node )
-			{
-				for( size_t i = 0; i < nodes.size(); i++ )
-				{
-					nodes[i].first = std::to_string( i );
-				}
-			}
+		std::size_t get_size() const
+		{
+			return 1;
 		}
 
-	public:
-		void push_back( std::nullptr_t )
+		void serialize( std::ostream & os ) const
 		{
-			assert( get_type() == element_type::array_node && "element_list< type::array_node >" );
+			char c = value ? 1 : 0;
 
-			nodes.push_back( { std::to_string( nodes.size() ), element< element_type::null_node >() } );
+			os.write( &c, 1 );
 		}
-		void push_back( bool val )
+
+		char * serialize( char * dst ) const
 		{
-			assert( get_type() == element_type::array_node && "element_list< type::array_node >" );
+			*dst = value ? 1 : 0;
 
-			nodes.push_back( { std::to_string( nodes.size() ), element< element_type::boolean_node >( val ) } );
+			return dst + 1;
 		}
-		void push_back( std::int32_t val )
+
+		void deserialize( std::istream & is )
 		{
-			assert( get_type() == element_type::array_node && "element_list< type::array_node >" );
+			char c;
+
+			is.read( &c, 1 );
 
-			nodes.push_back( { std::to_string( nodes.size() ), element< element_type::int32_node >( val ) } );
+			value = c == 1;
 		}
-		void push_back( std::int64_t val )
+
+	public:
+		void to_json( std::ostream & os ) const
 		{
-			assert( get_type() == element_type::array_node && "element_list< type::array_node >" );
+			os << ( value ? "true" : "false" );
+		}
 
-			nodes.push_back( { std::to_string( nodes.size() ), element< element_type::int64_node >( val ) } );
+		template< typename S > void from_json( S & is )
+		{
+			value = speek( is ) == 't' ? smatch( is, "true" ) : !smatch( is, "false" );
 		}
-		void push_back( std::uint64_t val )
+
+	private:
+		bool value;
+	};
+
+	template<> class element< element_type::min_key_node >
+	{
+	public:
+		element() = default;
+
+		element( std::nullptr_t )
 		{
-			assert( get_type() == element_type::array_node && "element_list< type::array_node >" );
 
-			nodes.push_back( { std::to_string( nodes.size() ), element< element_type::timestamp_node >( val ) } );
 		}
-		void push_back( float val )
-		{
-			assert( get_type() == element_type::array_node && "element_list< type::array_node >" );
 
-			nodes.push_back( { std::to_string( nodes.size() ), element< element_type::double_node >( val ) } );
+		element & operator=( std::nullptr_t )
+		{
+			return *this;
 		}
-		void push_back( double val )
+
+		~element() = default;
+
+	public:
+		element_type get_type() const
 		{
-			assert( get_type() == element_type::array_node && "element_list< type::array_node >" );
+			return element_type::min_key_node;
+		}
 
-			nodes.push_back( { std::to_string( nodes.size() ), element< element_type::double_node >( val ) } );
+		std::size_t get_size() const
+		{
+			return 0;
 		}
-		void push_back( const char * val )
+
+		void serialize( std::ostream & ) const
 		{
-			assert( get_type() == element_type::array_node && "element_list< type::array_node >" );
 
-			nodes.push_back( { std::to_string( nodes.size() ), element< element_type::string_node >( val ) } );
 		}
-		void push_back( std::string_view val )
-		{
-			assert( get_type() == element_type::array_node && "element_list< type::array_node >" );
 
-			nodes.push_back( { std::to_string( nodes.size() ), element< element_type::string_node >( std::string{ val.data(), val.size() } ) } );
+		char * serialize( char * dst ) const
+		{
+			return dst;
 		}
-		void push_back( const std::string & val )
+
+		void deserialize( std::istream & )
 		{
-			assert( get_type() == element_type::array_node && "element_list< type::array_node >" );
 
-			nodes.push_back( { std::to_string( nodes.size() ), element< element_type::string_node >( val ) } );
 		}
-		template< element_type T > void push_back( const element< T > & val )
+
+	public:
+		void to_json( std::ostream & os ) const
 		{
-			assert( get_type() == element_type::array_node && "element_list< type::array_node >" );
+			os << 1;
+		}
 
-			nodes.push_back( { std::to_string( nodes.size() ), val } );
+		template< typename S > void from_json( S & is )
+		{
+			if( !smatch( is, "1" ) )
+			{
+				throw std::runtime_error( "template< typename S > void from_json( S & is )" );
+			}
 		}
-		template< typename K, typename V > void push_back( const std::pair< K, V > & val )
+	};
+
+	template<> class element< element_type::max_key_node >
+	{
+	public:
+		element() = default;
+
+		element( std::nullptr_t )
 		{
-			assert( get_type() == element_type::document_node && "element_list< type::document_node >" );
 
-			insert( val.first, val.second );
 		}
-		template< typename ... T > void push_back( const std::chrono::time_point< T... > & val )
-		{
-			assert( get_type() == element_type::array_node && "element_list< type::array_node >" );
 
-			nodes.push_back( { std::to_string( nodes.size() ), element< element_type::datetime_node >( std::chrono::time_point< T... >::clock::to_time_t( val ) * 1000 ) } );
+		element & operator=( std::nullptr_t )
+		{
+			return *this;
 		}
 
+		~element() = default;
+
 	public:
-		void unpack() {}
-		template< typename T, typename ... Args > void unpack( T && val, Args &&... args )
+		element_type get_type() const
 		{
-			push_back( std::forward<T>( val ) );
+			return element_type::max_key_node;
+		}
 
-			unpack( args... );
+		std::size_t get_size() const
+		{
+			return 0;
 		}
 
-	public:
-		void insert( const std::string & key, std::nullptr_t )
+		void serialize( std::ostream & ) const
 		{
-			assert( get_type() == element_type::document_node && "element_list< type::document_node >" );
 
-			auto it = find( key );
-			if( it != end() )
-			{
-				it->second = element< element_type::null_node >();
-			}
-			else
-			{
-				nodes.push_back( { key, element< element_type::null_node >() } );
-			}
 		}
-		void insert( const std::string & key, bool val )
+
+		char * serialize( char * dst ) const
+		{
+			return dst;
+		}
+
+		void deserialize( std::istream & )
 		{
-			assert( get_type() == element_type::document_node && "element_list< type::document_node >" );
 
-			auto it = find( key );
-			if( it != end() )
-			{
-				it->second = element< element_type::boolean_node >( val );
-			}
-			else
-			{
-				nodes.push_back( { key, element< element_type::boolean_node >( val ) } );
-			}
 		}
-		void insert( const std::string & key, std::int32_t val )
+
+	public:
+		void to_json( std::ostream & os ) const
 		{
-			assert( get_type() == element_type::document_node && "element_list< type::document_node >" );
+			os << 1;
+		}
 
-			auto it = find( key );
-			if( it != end() )
-			{
-				it->second = element< element_type::int32_node >( val );
-			}
-			else
+		template< typename S > void from_json( S & is )
+		{
+			if( !smatch( is, "1" ) )
 			{
-				nodes.push_back( { key, element< element_type::int32_node >( val ) } );
+				throw std::runtime_error( "template< typename S > void from_json( S & is )" );
 			}
 		}
-		void insert( const std::string & key, std::int64_t val )
+	};
+
+	template<> class element< element_type::regular_node >
+	{
+	public:
+		element() = default;
+
+		explicit element( std::pmr::memory_resource * resource )
+			:pattern( resource ), options( resource )
 		{
-			assert( get_type() == element_type::document_node && "element_list< type::document_node >" );
 
-			auto it = find( key );
-			if( it != end() )
-			{
-				it->second = element< element_type::int64_node >( val );
-			}
-			else
-			{
-				nodes.push_back( { key, element< element_type::int64_node >( val ) } );
-			}
 		}
-		void insert( const std::string & key, std::uint64_t val )
+
+		element( std::string_view pattern, std::string_view options, std::pmr::memory_resource * resource = std::pmr::get_default_resource() )
+			:pattern( pattern, resource ), options( options, resource )
 		{
-			assert( get_type() == element_type::document_node && "element_list< type::document_node >" );
 
-			auto it = find( key );
-			if( it != end() )
-			{
-				it->second = element< element_type::timestamp_node >( val );
-			}
-			else
-			{
-				nodes.push_back( { key, element< element_type::timestamp_node >( val ) } );
-			}
 		}
-		void insert( const std::string & key, float val )
+
+		element( element< element_type::regular_node > && val ) noexcept
+			:pattern( std::move( val.pattern ) ), options( std::move( val.options ) )
 		{
-			assert( get_type() == element_type::document_node && "element_list< type::document_node >" );
 
-			auto it = find( key );
-			if( it != end() )
-			{
-				it->second = element< element_type::double_node >( val );
-			}
-			else
-			{
-				nodes.push_back( { key, element< element_type::double_node >( val ) } );
-			}
 		}
-		void insert( const std::string & key, double val )
+
+		element( const element< element_type::regular_node > & val )
+			:pattern( val.pattern ), options( val.options )
 		{
-			assert( get_type() == element_type::document_node && "element_list< type::document_node >" );
 
-			auto it = find( key );
-			if( it != end() )
-			{
-				it->second = element< element_type::double_node >( val );
-			}
-			else
-			{
-				nodes.push_back( { key, element< element_type::double_node >( val ) } );
-			}
 		}
-		void insert( const std::string & key, const char * val )
+
+		element & operator =( element< element_type::regular_node > && val )
 		{
-			assert( get_type() == element_type::document_node && "element_list< type::document_node >" );
+			pattern = std::move( val.pattern );
+			options = std::move( val.options );
+			return *this;
+		}
 
-			auto it = find( key );
-			if( it != end() )
-			{
-				it->second = element< element_type::string_node >( val );
-			}
-			else
-			{
-				nodes.push_back( { key, element< element_type::string_node >( val ) } );
-			}
+		element & operator =( const element< element_type::regular_node > & val )
+		{
+			pattern = val.pattern;
+			options = val.options;
+			return *this;
 		}
-		void insert( const std::string & key, std::string_view val )
+
+		~element() = default;
+
+	public:
+		void swap( element<element_type::regular_node> & val )
 		{
-			assert( get_type() == element_type::document_node && "element_list< type::document_node >" );
+			pmr_swap( pattern, val.pattern );
+			pmr_swap( options, val.options );
+		}
 
-			auto it = find( key );
-			if( it != end() )
-			{
-				it->second = element< element_type::string_node >( val );
-			}
-			else
-			{
-				nodes.push_back( { key, element< element_type::string_node >( val ) } );
-			}
+		std::string_view get_pattern() const
+		{
+			return pattern;
 		}
-		void insert( const std::string & key, const std::string & val )
+
+		std::string_view get_options() const
 		{
-			assert( get_type() == element_type::document_node && "element_list< type::document_node >" );
+			return options;
+		}
 
-			auto it = find( key );
-			if( it != end() )
-			{
-				it->second = element< element_type::string_node >( val );
-			}
-			else
-			{
-				nodes.push_back( { key, element< element_type::string_node >( val ) } );
-			}
+	public:
+		element_type get_type() const
+		{
+			return element_type::regular_node;
 		}
-		template< element_type T > void insert( const std::string & key, const element< T > & val )
+
+		std::size_t get_size() const
 		{
-			assert( get_type() == element_type::document_node && "element_list< type::document_node >" );
+			return pattern.size() + options.size() + 2;
+		}
 
-			auto it = find( key );
-			if( it != end() )
-			{
-				it->second = val;
-			}
-			else
-			{
-				nodes.push_back( { key, val } );
-			}
+		void serialize( std::ostream & os ) const
+		{
+			os.write( pattern.c_str(), pattern.size() + 1 );
+			os.write( options.c_str(), options.size() + 1 );
 		}
-		template< typename ... T > void insert( const std::string & key, const std::chrono::time_point< T... > & val )
+
+		char * serialize( char * dst ) const
 		{
-			assert( get_type() == element_type::document_node && "element_list< type::document_node >" );
+			std::memcpy( dst, pattern.c_str(), pattern.size() + 1 );
+			dst += pattern.size() + 1;
 
-			auto it = find( key );
-			if( it != end() )
+			std::memcpy( dst, options.c_str(), options.size() + 1 );
+			dst += options.size() + 1;
+
+			return dst;
+		}
+
+		void deserialize( std::istream & is )
+		{
+			while( !is.eof() )
 			{
-				it->second = element< element_type::datetime_node >( std::chrono::time_point< T... >::clock::to_time_t( val ) * 1000 );
+				char c = sget( is );
+
+				if( c == 0 )
+				{
+					break;
+				}
+
+				pattern.push_back( c );
 			}
-			else
+
+			while( !is.eof() )
 			{
-				nodes.push_back( { key, element< element_type::datetime_node >( std::chrono::time_point< T... >::clock::to_time_t( val ) * 1000 ) } );
+				char c = sget( is );
+
+				if( c == 0 )
+				{
+					break;
+				}
+
+				options.push_back( c );
 			}
 		}
 
 	public:
-		element_type get_type() const
+		void to_json( std::ostream & os ) const
 		{
-			return T;
+			os << R"({ "pattern" : ")" + pattern + R"(", "options" : ")" + options + "\" }";
 		}
 
-		std::size_t get_size() const
+		template< typename S > void from_json( S & is )
 		{
-			std::size_t result = 4;
-			for( const auto & it : nodes )
+			if( smatch( is, R"({"pattern":")" ) )
 			{
-				result += 1 + it.first.size() + 1 + get_node_size( it.second );
+				sappend( is, '\"', pattern );
 			}
-			return result + 1;
-		}
 
-		void serialize( std::ostream & os ) const
-		{
-			std::int32_t sz = static_cast<std::int32_t>( get_size() );
-
-			os.write( reinterpret_cast<const char *>( &sz ), sizeof( sz ) );
+			if( smatch( is, R"(","options":")" ) )
+			{
+				sappend( is, '\"', options );
+			}
 
-			for( auto it = begin(); it != end(); ++it )
+			if( !smatch( is, "\"}" ) )
 			{
-				char t = static_cast<char>( get_node_type( it->second ) );
-				os.write( &t, sizeof( t ) );
+				throw std::runtime_error( "template< typename S > void from_json( S & is )" );
+			}
+		}
 
-				os.write( it->first.c_str(), it->first.size() + 1 );
+	private:
+		std::pmr::string pattern, options;
+	};
 
-				node_serialize( os, it->second );
-			}
+	template<> class element< element_type::datetime_node >
+	{
+	public:
+		element() = default;
+
+		element( std::time_t val )
+			:value( val )
+		{
 
-			os.write( "\0", 1 );
 		}
 
-		void deserialize( std::istream & is )
+		element( const element< element_type::datetime_node > & val ) noexcept
+			:value( val.value )
 		{
-			std::int32_t sz = 0;
 
-			is.read( reinterpret_cast<char *>( &sz ), sizeof( sz ) );
+		}
 
-			while( true )
-			{
-				element_type t = element_type::unknown_node;
+		element & operator =( bool val )
+		{
+			value = val;
 
-				is.read( reinterpret_cast<char *>( &t ), sizeof( t ) );
+			return *this;
+		}
 
-				if( static_cast<std::uint8_t>( t ) == 0 )
-				{
-					return;
-				}
+		~element() = default;
 
-				std::string key;
+	public:
+		operator std::time_t() const
+		{
+			return value;
+		}
 
-				while( !is.eof() )
-				{
-					char c = sget( is );
+		std::time_t get_value() const
+		{
+			return value;
+		}
 
-					if( c == 0 )
-					{
-						break;
-					}
+	public:
+		element_type get_type() const
+		{
+			return element_type::datetime_node;
+		}
 
-					key.push_back( c );
-				}
+		std::size_t get_size() const
+		{
+			return sizeof( value );
+		}
 
-				node_t value; create_node( t, value );
+		void serialize( std::ostream & os ) const
+		{
+			os.write( reinterpret_cast<const char *>( &value ), sizeof( value ) );
+		}
 
-				node_deserialize( is, value );
+		char * serialize( char * dst ) const
+		{
+			return raw_store( dst, value );
+		}
 
-				nodes.push_back( { std::move( key ), std::move( value ) } );
-			}
+		void deserialize( std::istream & is )
+		{
+			is.read( reinterpret_cast<char *>( &value ), sizeof( value ) );
 		}
 
 	public:
 		void to_json( std::ostream & os ) const
 		{
-			if( get_type() == element_type::array_node )
-			{
-				os << "[ ";
-				{
-					for( size_t i = 0; i < nodes.size(); i++ )
-					{
-						node_to_json( os, nodes[i].second );
-						if( i < nodes.size() - 1 )
-						{
-							os << ", ";
-						}
-					}
-				}
-				os << " ]";
-			}
-			else
-			{
-				os << "{ ";
-				{
-					for( size_t i = 0; i < nodes.size(); i++ )
-					{
-						os << ( "\"" + nodes[i].first + "\" : " );
+			char buf[64];
 
-						node_to_json( os, nodes[i].second );
-						if( i < nodes.size() - 1 )
-						{
-							os << ", ";
-						}
-					}
-				}
-				os << " }";
-			}
+			os.write( buf, format_datetime( buf, value ) - buf );
 		}
 
-		void from_json( std::istream & is )
+		template< typename S > void from_json( S & is )
 		{
-			if( get_type() == element_type::array_node )
+			if( !smatch( is, "\"" ) )
 			{
-				assert( !is.eof() && sget( is ) == '[' && "void from_json( std::istream & is )" );
-				{
-					bool exit = false;
-					while( !exit )
-					{
-						node_t node;
-
-						node_from_json( is, node );
-
-						nodes.push_back( { std::to_string( nodes.size() ), node } );
-
-						switch( speek( is ) )
-						{
-						case ']':
-							exit = true;
-							break;
-						case ',':
-							sget( is );
-							break;
-						default:
-							assert( false && "void from_json( std::istream & is )" );
-							break;
-						}
-					}
-				}
-				assert( !is.eof() && sget( is ) == ']' && "void from_json( std::istream & is )" );
+				throw std::runtime_error( "template< typename S > void from_json( S & is )" );
 			}
-			else
+			value = parse_datetime( sread( is, 24 ) );
+			if( !smatch( is, "\"" ) )
 			{
-				assert( !is.eof() && sget( is ) == '{' && "void from_json( std::istream & is )" );
-				{
-					bool exit = false;
-					while( !exit )
-					{
-						element< element_type::string_node > key;
-
-						key.from_json( is );
-
-						assert( !is.eof() && sget( is ) == ':' && "void from_json( std::istream & is )" );
-
-						node_t value;
-
-						node_from_json( is, value );
-
-						nodes.push_back( { key.get_value(), value } );
-
-						switch( speek( is ) )
-						{
-						case '}':
-							exit = true;
-							break;
-						case ',':
-							sget( is );
-							break;
-						default:
-							assert( false && "void from_json( std::istream & is )" );
-							break;
-						}
-					}
-				}
-				assert( !is.eof() && sget( is ) == '}' && "void from_json( std::istream & is )" );
+				throw std::runtime_error( "template< typename S > void from_json( S & is )" );
 			}
 		}
 
 	private:
-		std::vector< mapped_type > nodes;
+		std::time_t value = 0;
 	};
 
-	template<> class element< element_type::unknown_node >;
-
-	template< typename ... T > void create_node( element_type val, std::variant< T... > & node )
+	template<> class element< element_type::timestamp_node >
 	{
-		switch( val )
+	public:
+		element() = default;
+
+		element( std::uint64_t val )
+			:value( val )
 		{
-		case bson::element_type::null_node:
-			node = element< element_type::null_node >();
-			break;
-		case bson::element_type::int32_node:
+
+		}
+
+		template< typename ... T > element( const std::chrono::time_point< T... > & val )
+		{
+			value = std::chrono::duration_cast<std::chrono::milliseconds>( val ).count();
+		}
+
+		element( const element< element_type::timestamp_node > & val ) noexcept
+			:value( val.value )
+		{
+
+		}
+
+		element & operator =( bool val )
+		{
+			value = val;
+
+			return *this;
+		}
+
+		~element() = default;
+
+	public:
+		operator std::uint64_t() const
+		{
+			return value;
+		}
+
+		std::uint64_t get_value() const
+		{
+			return value;
+		}
+
+	public:
+		element_type get_type() const
+		{
+			return element_type::timestamp_node;
+		}
+
+		std::size_t get_size() const
+		{
+			return sizeof( value );
+		}
+
+		void serialize( std::ostream & os ) const
+		{
+			os.write( reinterpret_cast<const char *>( &value ), sizeof( value ) );
+		}
+
+		char * serialize( char * dst ) const
+		{
+			return raw_store( dst, value );
+		}
+
+		void deserialize( std::istream & is )
+		{
+			is.read( reinterpret_cast<char *>( &value ), sizeof( value ) );
+		}
+
+	public:
+		void to_json( std::ostream & os ) const
+		{
+			os << R"({ "t" : )";
+			write_number( os, value );
+			os << R"(, "i" : 1 })";
+		}
+
+		template< typename S > void from_json( S & is )
+		{
+			if( !smatch( is, R"({"t":)" ) )
+			{
+				throw std::runtime_error( "template< typename S > void from_json( S & is )" );
+			}
+			{
+				char buf[32];
+
+				value = parse_number< std::uint64_t >( snumber( is, buf, sizeof( buf ) ) );
+			}
+			if( !smatch( is, R"(,"i":1})" ) )
+			{
+				throw std::runtime_error( "template< typename S > void from_json( S & is )" );
+			}
+		}
+
+	private:
+		std::uint64_t value = 0;
+	};
+
+	template<> class element< element_type::object_id_node >
+	{
+	public:
+		element() = default;
+
+		element( element< element_type::object_id_node > && val ) noexcept
+		{
+			swap( val );
+		}
+
+		element( const element< element_type::object_id_node > & val )
+			:value( val.value )
+		{
+
+		}
+
+		element( std::string_view val )
+		{
+			if( val.size() != value.size() * 2 )
+			{
+				throw std::invalid_argument( "element( std::string_view val )" );
+			}
+
+			hex_decode( value.data(), val.data(), val.size() );
+		}
+
+		element( const std::array<char, 12> & val )
+			:value( val )
+		{
+
+		}
+
+		element & operator =( element< element_type::object_id_node > && val )
+		{
+			swap( val );
+
+			return *this;
+		}
+
+		element & operator =( const element< element_type::object_id_node > & val )
+		{
+			value = val.value;
+
+			return *this;
+		}
+
+		element & operator =( const std::array<char, 12> & val )
+		{
+			value = val;
+
+			return *this;
+		}
+
+		~element() = default;
+
+	public:
+		void swap( element< element_type::object_id_node > & val )
+		{
+			std::swap( value, val.value );
+		}
+
+	public:
+		static element< element_type::object_id_node > generate()
+		{
+			static const std::array<char, 5> process = []()
+			{
+				std::random_device device;
+
+				std::array<char, 5> result;
+				for( auto & c : result )
+				{
+					c = static_cast<char>( device() );
+				}
+				return result;
+			}();
+			static std::atomic< std::uint32_t > counter( std::random_device{}() );
+
+			auto seconds = static_cast<std::uint32_t>( std::chrono::duration_cast< std::chrono::seconds >( std::chrono::system_clock::now().time_since_epoch() ).count() );
+			auto count = counter.fetch_add( 1, std::memory_order_relaxed );
+
+			// 4 byte big endian seconds, 5 byte per process random, 3 byte big endian counter
+			std::array<char, 12> result;
+			result[0] = static_cast<char>( seconds >> 24 );
+			result[1] = static_cast<char>( seconds >> 16 );
+			result[2] = static_cast<char>( seconds >> 8 );
+			result[3] = static_cast<char>( seconds );
+			std::memcpy( result.data() + 4, process.data(), process.size() );
+			result[9] = static_cast<char>( count >> 16 );
+			result[10] = static_cast<char>( count >> 8 );
+			result[11] = static_cast<char>( count );
+
+			return result;
+		}
+
+	public:
+		operator const std::array<char, 12> & ( ) const
+		{
+			return value;
+		}
+
+		const std::array<char, 12> & get_value() const
+		{
+			return value;
+		}
+
+	public:
+		element_type get_type() const
+		{
+			return element_type::object_id_node;
+		}
+
+		std::size_t get_size() const
+		{
+			return 12;
+		}
+
+		void serialize( std::ostream & os ) const
+		{
+			os.write( value.data(), 12 );
+		}
+
+		char * serialize( char * dst ) const
+		{
+			std::memcpy( dst, value.data(), 12 );
+
+			return dst + 12;
+		}
+
+		void deserialize( std::istream & is )
+		{
+			is.read( value.data(), 12 );
+		}
+
+	public:
+		void to_json( std::ostream & os ) const
+		{
+			char buf[26];
+
+			buf[0] = '\"';
+			hex_encode( buf + 1, value.data(), value.size() );
+			buf[25] = '\"';
+
+			os.write( buf, sizeof( buf ) );
+		}
+
+		template< typename S > void from_json( S & is )
+		{
+			if( !smatch( is, "\"" ) )
+			{
+				throw std::runtime_error( "template< typename S > void from_json( S & is )" );
+			}
+			{
+				char hex[24];
+				for( auto & c : hex )
+				{
+					c = static_cast<char>( is.get() );
+				}
+
+				hex_decode( value.data(), hex, sizeof( hex ) );
+			}
+			if( !smatch( is, "\"" ) )
+			{
+				throw std::runtime_error( "template< typename S > void from_json( S & is )" );
+			}
+		}
+
+	private:
+		std::array<char, 12> value;
+	};
+
+	template<> class element< element_type::array_node >
+	{
+	public:
+		using node_t = std::variant< std::monostate,
+			element< element_type::null_node >,
+			element< element_type::int32_node >,
+			element< element_type::int64_node >,
+			element< element_type::array_node >,
+			element< element_type::double_node >,
+			element< element_type::string_node >,
+			element< element_type::binary_node >,
+			element< element_type::boolean_node >,
+			element< element_type::min_key_node >,
+			element< element_type::max_key_node >,
+			element< element_type::regular_node >,
+			element< element_type::datetime_node >,
+			element< element_type::document_node >,
+			element< element_type::timestamp_node >,
+			element< element_type::object_id_node >
+		>;
+
+	public:
+		using value_type = node_t;
+		using iterator = std::pmr::vector< node_t >::iterator;
+		using const_iterator = std::pmr::vector< node_t >::const_iterator;
+
+	public:
+		element() = default;
+
+		explicit element( std::pmr::memory_resource * resource )
+			:nodes( resource )
+		{
+
+		}
+
+		template< typename ... U, typename = std::enable_if_t< !is_memory_resource< U... >::value > > element( U &&... args )
+		{
+			unpack( args... );
+		}
+
+		element( element< element_type::array_node > && val ) noexcept
+			:nodes( std::move( val.nodes ) ), cache_size( val.cache_size ), cache_tracked( val.cache_tracked )
+		{
+			val.cache_size = 0;
+			val.cache_tracked = true;
+		}
+
+		element( const element< element_type::array_node > & val );
+		element & operator =( element< element_type::array_node > && val );
+		element & operator =( const element< element_type::array_node > & val );
+
+		~element() = default;
+
+	public:
+		std::pmr::memory_resource * get_resource() const
+		{
+			return nodes.get_allocator().resource();
+		}
+
+	public:
+		void swap( element< element_type::array_node > & val );
+
+	public:
+		value_type & operator[]( std::size_t i );
+		const value_type & operator[]( std::size_t i ) const;
+
+	public:
+		bool empty() const
+		{
+			return nodes.empty();
+		}
+
+		std::size_t size() const
+		{
+			return nodes.size();
+		}
+
+	public:
+		iterator begin()
+		{
+			cache_tracked = false;
+
+			return nodes.begin();
+		}
+
+		iterator end()
+		{
+			cache_tracked = false;
+
+			return nodes.end();
+		}
+
+		const_iterator begin() const
+		{
+			return nodes.begin();
+		}
+
+		const_iterator end() const
+		{
+			return nodes.end();
+		}
+
+	public:
+		void erase( const_iterator val );
+
+	public:
+		void push_back( std::nullptr_t );
+		void push_back( bool val );
+		void push_back( std::int32_t val );
+		void push_back( std::int64_t val );
+		void push_back( std::uint64_t val );
+		void push_back( float val );
+		void push_back( double val );
+		void push_back( const char * val );
+		void push_back( std::string_view val );
+		void push_back( const std::string & val );
+		template< element_type T > void push_back( const element< T > & val )
+		{
+			push_node( val );
+		}
+		template< typename ... T > void push_back( const std::chrono::time_point< T... > & val )
+		{
+			push_node( element< element_type::datetime_node >( std::chrono::time_point< T... >::clock::to_time_t( val ) * 1000 ) );
+		}
+
+	public:
+		void unpack() {}
+		template< typename U, typename ... Args > void unpack( U && val, Args &&... args )
+		{
+			push_back( std::forward<U>( val ) );
+
+			unpack( args... );
+		}
+
+	public:
+		element_type get_type() const
+		{
+			return element_type::array_node;
+		}
+
+		std::size_t get_size() const;
+		void serialize( std::ostream & os ) const;
+		char * serialize( char * dst ) const;
+		std::size_t serialize_to( char * data, std::size_t size ) const;
+		void serialize_to( std::vector<char> & buf ) const;
+		void deserialize( std::istream & is );
+		void deserialize( const document_view & view );
+
+	public:
+		void to_json( std::ostream & os ) const;
+		template< typename S > void from_json( S & is );
+
+	private:
+		std::size_t values_size() const;
+		template< typename V > void push_node( V && val )
+		{
+			auto & node = nodes.emplace_back( std::forward<V>( val ) );
+
+			if( cache_tracked )
+			{
+				cache_size += get_node_size( node );
+			}
+		}
+
+	private:
+		std::pmr::vector< node_t > nodes;
+		// encoded size of the values alone, the "0", "1", ... keys are implied
+		// by the position and added by get_size(); tracked as in documents
+		mutable std::size_t cache_size = 0;
+		mutable bool cache_tracked = true;
+	};
+
+
+
+	template< element_type T > class element
+	{
+	public:
+		using node_t = std::variant< std::monostate,
+			element< element_type::null_node >,
+			element< element_type::int32_node >,
+			element< element_type::int64_node >,
+			element< element_type::array_node >,
+			element< element_type::double_node >,
+			element< element_type::string_node >,
+			element< element_type::binary_node >,
+			element< element_type::boolean_node >,
+			element< element_type::min_key_node >,
+			element< element_type::max_key_node >,
+			element< element_type::regular_node >,
+			element< element_type::datetime_node >,
+			element< element_type::document_node >,
+			element< element_type::timestamp_node >,
+			element< element_type::object_id_node >
+		>;
+
+	public:
+		using value_type = node_t;
+		using key_type = std::pmr::string;
+		using mapped_type = std::pair< key_type, node_t >;
+		using iterator = typename std::pmr::vector< mapped_type >::iterator;
+		using const_iterator = typename std::pmr::vector< mapped_type >::const_iterator;
+
+	public:
+		element() = default;
+
+		explicit element( std::pmr::memory_resource * resource )
+			:nodes( resource ), index( resource )
+		{
+
+		}
+
+		template< typename ... U, typename = std::enable_if_t< !is_memory_resource< U... >::value > > element( U &&... args )
+		{
+			unpack( args... );
+		}
+
+		element( element<T> && val ) noexcept
+			:nodes( std::move( val.nodes ) ), cache_size( val.cache_size ), cache_tracked( val.cache_tracked ), index( std::move( val.index ) )
+		{
+			val.cache_size = 5;
+			val.cache_tracked = true;
+		}
+
+		element( const element<T> & val )
+			:nodes( val.nodes ), cache_size( val.get_size() ), index( val.index )
+		{
+
+		}
+
+		element & operator =( element<T> && val )
+		{
+			nodes = std::move( val.nodes );
+			cache_size = val.cache_size;
+			cache_tracked = val.cache_tracked;
+			index = std::move( val.index );
+
+			val.nodes.clear();
+			val.index.clear();
+			val.cache_size = 5;
+			val.cache_tracked = true;
+
+			return *this;
+		}
+
+		element & operator =( const element<T> & val )
+		{
+			nodes = val.nodes;
+			cache_size = val.get_size();
+			cache_tracked = true;
+			index = val.index;
+
+			return *this;
+		}
+
+		~element() = default;
+
+	public:
+		std::pmr::memory_resource * get_resource() const
+		{
+			return nodes.get_allocator().resource();
+		}
+
+	public:
+		void swap( element<T> & val )
+		{
+			pmr_swap( nodes, val.nodes );
+			std::swap( cache_size, val.cache_size );
+			std::swap( cache_tracked, val.cache_tracked );
+			pmr_swap( index, val.index );
+		}
+
+	public:
+		value_type & operator[]( const std::string & key )
+		{
+			assert( get_type() == element_type::document_node && "element_list< type::document_node >" );
+
+			cache_tracked = false;
+
+			std::size_t i = index_of( key );
+			if( i != nodes.size() )
+			{
+				return nodes[i].second;
+			}
+
+			append_node( key, value_type{} );
+
+			return nodes.back().second;
+		}
+
+		const value_type & operator[]( const std::string & key ) const
+		{
+			assert( get_type() == element_type::document_node && "element_list< type::document_node >" );
+
+			std::size_t i = index_of( key );
+			if( i != nodes.size() )
+			{
+				return nodes[i].second;
+			}
+
+			throw std::out_of_range( "const value_type & operator[]( const std::string & key ) const" );
+		}
+
+	public:
+		bool empty() const
+		{
+			return nodes.empty();
+		}
+
+	public:
+		iterator begin()
+		{
+			cache_tracked = false;
+
+			return nodes.begin();
+		}
+
+		iterator end()
+		{
+			cache_tracked = false;
+
+			return nodes.end();
+		}
+
+		const_iterator begin() const
+		{
+			return nodes.begin();
+		}
+
+		const_iterator end() const
+		{
+			return nodes.end();
+		}
+
+	public:
+		iterator find( const std::string & key )
+		{
+			cache_tracked = false;
+
+			return nodes.begin() + index_of( key );
+		}
+
+		const_iterator find( const std::string & key ) const
+		{
+			return nodes.begin() + index_of( key );
+		}
+
+	public:
+		void erase( const_iterator val )
+		{
+			if( cache_tracked )
+			{
+				cache_size -= 1 + val->first.size() + 1 + get_node_size( val->second );
+			}
+
+			nodes.erase( val );
+
+			reindex();
+		}
+
+	public:
+		template< typename K, typename V > void push_back( const std::pair< K, V > & val )
+		{
+			assert( get_type() == element_type::document_node && "element_list< type::document_node >" );
+
+			insert( val.first, val.second );
+		}
+	public:
+		void unpack() {}
+		template< typename U, typename ... Args > void unpack( U && val, Args &&... args )
+		{
+			push_back( std::forward<U>( val ) );
+
+			unpack( args... );
+		}
+
+	public:
+		void insert( const std::string & key, std::nullptr_t )
+		{
+			assert( get_type() == element_type::document_node && "element_list< type::document_node >" );
+
+			insert_node( key, element< element_type::null_node >() );
+		}
+		void insert( const std::string & key, bool val )
+		{
+			assert( get_type() == element_type::document_node && "element_list< type::document_node >" );
+
+			insert_node( key, element< element_type::boolean_node >( val ) );
+		}
+		void insert( const std::string & key, std::int32_t val )
+		{
+			assert( get_type() == element_type::document_node && "element_list< type::document_node >" );
+
+			insert_node( key, element< element_type::int32_node >( val ) );
+		}
+		void insert( const std::string & key, std::int64_t val )
+		{
+			assert( get_type() == element_type::document_node && "element_list< type::document_node >" );
+
+			insert_node( key, element< element_type::int64_node >( val ) );
+		}
+		void insert( const std::string & key, std::uint64_t val )
+		{
+			assert( get_type() == element_type::document_node && "element_list< type::document_node >" );
+
+			insert_node( key, element< element_type::timestamp_node >( val ) );
+		}
+		void insert( const std::string & key, float val )
+		{
+			assert( get_type() == element_type::document_node && "element_list< type::document_node >" );
+
+			insert_node( key, element< element_type::double_node >( val ) );
+		}
+		void insert( const std::string & key, double val )
+		{
+			assert( get_type() == element_type::document_node && "element_list< type::document_node >" );
+
+			insert_node( key, element< element_type::double_node >( val ) );
+		}
+		void insert( const std::string & key, const char * val )
+		{
+			assert( get_type() == element_type::document_node && "element_list< type::document_node >" );
+
+			insert_node( key, element< element_type::string_node >( val, get_resource() ) );
+		}
+		void insert( const std::string & key, std::string_view val )
+		{
+			assert( get_type() == element_type::document_node && "element_list< type::document_node >" );
+
+			insert_node( key, element< element_type::string_node >( val, get_resource() ) );
+		}
+		void insert( const std::string & key, const std::string & val )
+		{
+			assert( get_type() == element_type::document_node && "element_list< type::document_node >" );
+
+			insert_node( key, element< element_type::string_node >( val, get_resource() ) );
+		}
+		template< element_type U > void insert( const std::string & key, const element< U > & val )
+		{
+			assert( get_type() == element_type::document_node && "element_list< type::document_node >" );
+
+			insert_node( key, val );
+		}
+		template< typename ... U > void insert( const std::string & key, const std::chrono::time_point< U... > & val )
+		{
+			assert( get_type() == element_type::document_node && "element_list< type::document_node >" );
+
+			insert_node( key, element< element_type::datetime_node >( std::chrono::time_point< U... >::clock::to_time_t( val ) * 1000 ) );
+		}
+
+	public:
+		element_type get_type() const
+		{
+			return T;
+		}
+
+		std::size_t get_size() const
+		{
+			if( !cache_tracked )
+			{
+				cache_size = compute_size();
+				cache_tracked = true;
+			}
+
+			return cache_size;
+		}
+
+		void serialize( std::ostream & os ) const
+		{
+			std::vector<char> buf;
+
+			serialize_to( buf );
+
+			os.write( buf.data(), buf.size() );
+		}
+
+		char * serialize( char * dst ) const
+		{
+			char * beg = dst;
+
+			dst += sizeof( std::int32_t );
+
+			for( auto it = begin(); it != end(); ++it )
+			{
+				*dst++ = static_cast<char>( get_node_type( it->second ) );
+
+				std::memcpy( dst, it->first.c_str(), it->first.size() + 1 );
+				dst += it->first.size() + 1;
+
+				dst = node_serialize( dst, it->second );
+			}
+
+			*dst++ = 0;
+
+			raw_store( beg, static_cast<std::int32_t>( dst - beg ) );
+
+			return dst;
+		}
+
+		std::size_t serialize_to( char * data, std::size_t size ) const
+		{
+			std::size_t sz = get_size();
+			if( sz > size )
+			{
+				throw std::out_of_range( "std::size_t serialize_to( char * data, std::size_t size ) const" );
+			}
+
+			serialize( data );
+
+			return sz;
+		}
+
+		void serialize_to( std::vector<char> & buf ) const
+		{
+			std::size_t pos = buf.size();
+
+			buf.resize( pos + get_size() );
+
+			serialize( buf.data() + pos );
+		}
+
+		void deserialize( std::istream & is )
+		{
+			std::int32_t sz = 0;
+
+			is.read( reinterpret_cast<char *>( &sz ), sizeof( sz ) );
+
+			while( true )
+			{
+				element_type t = element_type::unknown_node;
+
+				is.read( reinterpret_cast<char *>( &t ), sizeof( t ) );
+
+				if( static_cast<std::uint8_t>( t ) == 0 )
+				{
+					return;
+				}
+
+				std::string key;
+
+				while( !is.eof() )
+				{
+					char c = sget( is );
+
+					if( c == 0 )
+					{
+						break;
+					}
+
+					key.push_back( c );
+				}
+
+				node_t value; create_node( t, value, get_resource() );
+
+				node_deserialize( is, value, get_resource() );
+
+				append_node( std::move( key ), std::move( value ) );
+			}
+		}
+
+		void deserialize( const document_view & view )
+		{
+			for( const auto & it : view )
+			{
+				node_t value;
+
+				node_deserialize( it.second, value, get_resource() );
+
+				append_node( it.first, std::move( value ) );
+			}
+		}
+
+		void deserialize( const document_view & view, const projection & proj )
+		{
+			deserialize( view, proj, 0 );
+		}
+
+	public:
+		void to_json( std::ostream & os ) const
+		{
+			os << "{ ";
+			{
+				for( size_t i = 0; i < nodes.size(); i++ )
+				{
+					os << ( "\"" + nodes[i].first + "\" : " );
+
+					node_to_json( os, nodes[i].second );
+					if( i < nodes.size() - 1 )
+					{
+						os << ", ";
+					}
+				}
+			}
+			os << " }";
+		}
+
+		template< typename S > void from_json( S & is )
+		{
+			if( is.eof() || sget( is ) != '{' )
+			{
+				throw std::runtime_error( "template< typename S > void from_json( S & is )" );
+			}
+			{
+				bool exit = speek( is ) == '}';
+				while( !exit )
+				{
+					element< element_type::string_node > key( get_resource() );
+
+					key.from_json( is );
+
+					if( is.eof() || sget( is ) != ':' )
+					{
+						throw std::runtime_error( "template< typename S > void from_json( S & is )" );
+					}
+
+					node_t value;
+
+					node_from_json( is, value, get_resource() );
+
+					append_node( key.get_value(), std::move( value ) );
+
+					switch( speek( is ) )
+					{
+					case '}':
+						exit = true;
+						break;
+					case ',':
+						sget( is );
+						break;
+					default:
+						throw std::runtime_error( "template< typename S > void from_json( S & is )" );
+						break;
+					}
+				}
+			}
+			if( is.eof() || sget( is ) != '}' )
+			{
+				throw std::runtime_error( "template< typename S > void from_json( S & is )" );
+			}
+		}
+
+	private:
+		void deserialize( const document_view & view, const projection & proj, std::size_t node )
+		{
+			// unselected values are stepped over by the view iterator using their length prefixes
+			for( const auto & it : view )
+			{
+				std::size_t child = proj.find( node, it.first );
+				if( child == projection::npos )
+				{
+					continue;
+				}
+
+				if( proj.is_leaf( child ) )
+				{
+					node_t value;
+
+					node_deserialize( it.second, value, get_resource() );
+
+					append_node( it.first, std::move( value ) );
+				}
+				else if( it.second.get_type() == element_type::document_node )
+				{
+					element< element_type::document_node > doc( get_resource() );
+
+					doc.deserialize( it.second.get_document(), proj, child );
+
+					append_node( it.first, std::move( doc ) );
+				}
+			}
+		}
+
+		std::size_t compute_size() const
+		{
+			std::size_t result = 4;
+			for( const auto & it : nodes )
+			{
+				result += 1 + it.first.size() + 1 + get_node_size( it.second );
+			}
+			return result + 1;
+		}
+		template< typename V > void insert_node( std::string_view key, V && val )
+		{
+			auto it = nodes.begin() + index_of( key );
+			if( it != nodes.end() )
+			{
+				if( cache_tracked )
+				{
+					cache_size -= get_node_size( it->second );
+				}
+
+				it->second = std::forward<V>( val );
+
+				if( cache_tracked )
+				{
+					cache_size += get_node_size( it->second );
+				}
+			}
+			else
+			{
+				append_node( key, std::forward<V>( val ) );
+			}
+		}
+		template< typename V > void append_node( std::string_view key, V && val )
+		{
+			nodes.emplace_back( std::piecewise_construct, std::forward_as_tuple( key ), std::forward_as_tuple( std::forward<V>( val ) ) );
+
+			if( cache_tracked )
+			{
+				cache_size += 1 + nodes.back().first.size() + 1 + get_node_size( nodes.back().second );
+			}
+
+			if( !index.empty() && nodes.size() * 2 <= index.size() )
+			{
+				index_insert( nodes.size() - 1 );
+			}
+			else if( nodes.size() >= index_threshold )
+			{
+				reindex();
+			}
+		}
+		std::size_t index_of( std::string_view key ) const
+		{
+			if( index.empty() )
+			{
+				for( std::size_t i = 0; i < nodes.size(); i++ )
+				{
+					if( nodes[i].first == key )
+					{
+						return i;
+					}
+				}
+				return nodes.size();
+			}
+
+			std::size_t mask = index.size() - 1;
+			for( std::size_t i = std::hash< std::string_view >()( key ) & mask; index[i] != 0; i = ( i + 1 ) & mask )
+			{
+				if( nodes[index[i] - 1].first == key )
+				{
+					return index[i] - 1;
+				}
+			}
+			return nodes.size();
+		}
+		void index_insert( std::size_t pos )
+		{
+			std::size_t mask = index.size() - 1;
+			std::size_t i = std::hash< std::string_view >()( nodes[pos].first ) & mask;
+			while( index[i] != 0 )
+			{
+				i = ( i + 1 ) & mask;
+			}
+			index[i] = static_cast<std::uint32_t>( pos + 1 );
+		}
+		void reindex()
+		{
+			index.clear();
+
+			if( nodes.size() >= index_threshold )
+			{
+				std::size_t cap = index_threshold * 2;
+				while( cap < nodes.size() * 4 )
+				{
+					cap *= 2;
+				}
+
+				index.resize( cap, 0 );
+				for( std::size_t i = 0; i < nodes.size(); i++ )
+				{
+					index_insert( i );
+				}
+			}
+		}
+
+	private:
+		std::pmr::vector< mapped_type > nodes;
+		// encoded size kept current by our own mutators; once a mutable reference
+		// to a child has been handed out we can no longer see every change, so
+		// the next get_size() walks the children and tracks again from there.
+		// a reference handed out before that call must not be used to resize
+		// a child after it, just as if an insert had invalidated it
+		mutable std::size_t cache_size = 5;
+		mutable bool cache_tracked = true;
+		// open addressing table over nodes ( position + 1, 0 is empty ), built
+		// once a document reaches index_threshold fields; nodes keeps the order
+		static constexpr std::size_t index_threshold = 16;
+		std::pmr::vector< std::uint32_t > index;
+	};
+
+	// defined here rather than in the class, node_t needs element< document_node > complete
+	inline element< element_type::array_node >::element( const element< element_type::array_node > & val )
+		:nodes( val.nodes ), cache_size( val.values_size() )
+	{
+
+	}
+
+	inline element< element_type::array_node > & element< element_type::array_node >::operator =( element< element_type::array_node > && val )
+	{
+		nodes = std::move( val.nodes );
+		cache_size = val.cache_size;
+		cache_tracked = val.cache_tracked;
+
+		val.nodes.clear();
+		val.cache_size = 0;
+		val.cache_tracked = true;
+
+		return *this;
+	}
+
+	inline element< element_type::array_node > & element< element_type::array_node >::operator =( const element< element_type::array_node > & val )
+	{
+		nodes = val.nodes;
+		cache_size = val.values_size();
+		cache_tracked = true;
+
+		return *this;
+	}
+
+	inline void element< element_type::array_node >::swap( element< element_type::array_node > & val )
+	{
+		pmr_swap( nodes, val.nodes );
+		std::swap( cache_size, val.cache_size );
+		std::swap( cache_tracked, val.cache_tracked );
+	}
+
+	inline element< element_type::array_node >::value_type & element< element_type::array_node >::operator[]( std::size_t i )
+	{
+		cache_tracked = false;
+
+		return nodes[i];
+	}
+
+	inline const element< element_type::array_node >::value_type & element< element_type::array_node >::operator[]( std::size_t i ) const
+	{
+		return nodes[i];
+	}
+
+	inline void element< element_type::array_node >::erase( const_iterator val )
+	{
+		if( cache_tracked )
+		{
+			cache_size -= get_node_size( *val );
+		}
+
+		nodes.erase( val );
+	}
+
+	inline void element< element_type::array_node >::push_back( std::nullptr_t )
+	{
+		push_node( element< element_type::null_node >() );
+	}
+
+	inline void element< element_type::array_node >::push_back( bool val )
+	{
+		push_node( element< element_type::boolean_node >( val ) );
+	}
+
+	inline void element< element_type::array_node >::push_back( std::int32_t val )
+	{
+		push_node( element< element_type::int32_node >( val ) );
+	}
+
+	inline void element< element_type::array_node >::push_back( std::int64_t val )
+	{
+		push_node( element< element_type::int64_node >( val ) );
+	}
+
+	inline void element< element_type::array_node >::push_back( std::uint64_t val )
+	{
+		push_node( element< element_type::timestamp_node >( val ) );
+	}
+
+	inline void element< element_type::array_node >::push_back( float val )
+	{
+		push_node( element< element_type::double_node >( val ) );
+	}
+
+	inline void element< element_type::array_node >::push_back( double val )
+	{
+		push_node( element< element_type::double_node >( val ) );
+	}
+
+	inline void element< element_type::array_node >::push_back( const char * val )
+	{
+		push_node( element< element_type::string_node >( val, get_resource() ) );
+	}
+
+	inline void element< element_type::array_node >::push_back( std::string_view val )
+	{
+		push_node( element< element_type::string_node >( val, get_resource() ) );
+	}
+
+	inline void element< element_type::array_node >::push_back( const std::string & val )
+	{
+		push_node( element< element_type::string_node >( val, get_resource() ) );
+	}
+
+	inline std::size_t element< element_type::array_node >::get_size() const
+	{
+		return 4 + array_keys_size( nodes.size() ) + values_size() + 1;
+	}
+
+	inline void element< element_type::array_node >::serialize( std::ostream & os ) const
+	{
+		std::vector<char> buf;
+
+		serialize_to( buf );
+
+		os.write( buf.data(), buf.size() );
+	}
+
+	inline char * element< element_type::array_node >::serialize( char * dst ) const
+	{
+		char * beg = dst;
+
+		dst += sizeof( std::int32_t );
+
+		char buf[24];
+		for( std::size_t i = 0; i < nodes.size(); i++ )
+		{
+			*dst++ = static_cast<char>( get_node_type( nodes[i] ) );
+
+			auto key = array_key( i, buf );
+			std::memcpy( dst, key.data(), key.size() );
+			dst += key.size();
+			*dst++ = 0;
+
+			dst = node_serialize( dst, nodes[i] );
+		}
+
+		*dst++ = 0;
+
+		raw_store( beg, static_cast<std::int32_t>( dst - beg ) );
+
+		return dst;
+	}
+
+	inline std::size_t element< element_type::array_node >::serialize_to( char * data, std::size_t size ) const
+	{
+		std::size_t sz = get_size();
+		if( sz > size )
+		{
+			throw std::out_of_range( "std::size_t serialize_to( char * data, std::size_t size ) const" );
+		}
+
+		serialize( data );
+
+		return sz;
+	}
+
+	inline void element< element_type::array_node >::serialize_to( std::vector<char> & buf ) const
+	{
+		std::size_t pos = buf.size();
+
+		buf.resize( pos + get_size() );
+
+		serialize( buf.data() + pos );
+	}
+
+	inline void element< element_type::array_node >::deserialize( std::istream & is )
+	{
+		std::int32_t sz = 0;
+
+		is.read( reinterpret_cast<char *>( &sz ), sizeof( sz ) );
+
+		while( true )
+		{
+			element_type t = element_type::unknown_node;
+
+			is.read( reinterpret_cast<char *>( &t ), sizeof( t ) );
+
+			if( static_cast<std::uint8_t>( t ) == 0 )
+			{
+				return;
+			}
+
+			while( !is.eof() && sget( is ) != 0 )
+			{
+			}
+
+			node_t value; create_node( t, value, get_resource() );
+
+			node_deserialize( is, value, get_resource() );
+
+			push_node( std::move( value ) );
+		}
+	}
+
+	inline void element< element_type::array_node >::deserialize( const document_view & view )
+	{
+		for( const auto & it : view )
+		{
+			node_t value;
+
+			node_deserialize( it.second, value, get_resource() );
+
+			push_node( std::move( value ) );
+		}
+	}
+
+	inline void element< element_type::array_node >::to_json( std::ostream & os ) const
+	{
+		os << "[ ";
+		{
+			for( size_t i = 0; i < nodes.size(); i++ )
+			{
+				node_to_json( os, nodes[i] );
+				if( i < nodes.size() - 1 )
+				{
+					os << ", ";
+				}
+			}
+		}
+		os << " ]";
+	}
+
+	template< typename S > inline void element< element_type::array_node >::from_json( S & is )
+	{
+		if( is.eof() || sget( is ) != '[' )
+		{
+			throw std::runtime_error( "template< typename S > void from_json( S & is )" );
+		}
+		{
+			bool exit = speek( is ) == ']';
+			while( !exit )
+			{
+				node_t node;
+
+				node_from_json( is, node, get_resource() );
+
+				push_node( std::move( node ) );
+
+				switch( speek( is ) )
+				{
+				case ']':
+					exit = true;
+					break;
+				case ',':
+					sget( is );
+					break;
+				default:
+					throw std::runtime_error( "template< typename S > void from_json( S & is )" );
+					break;
+				}
+			}
+		}
+		if( is.eof() || sget( is ) != ']' )
+		{
+			throw std::runtime_error( "template< typename S > void from_json( S & is )" );
+		}
+	}
+
+	inline std::size_t element< element_type::array_node >::values_size() const
+	{
+		if( !cache_tracked )
+		{
+			std::size_t result = 0;
+			for( const auto & it : nodes )
+			{
+				result += get_node_size( it );
+			}
+
+			cache_size = result;
+			cache_tracked = true;
+		}
+
+		return cache_size;
+	}
+	template<> class element< element_type::unknown_node >;
+
+	template< typename ... T > void create_node( element_type val, std::variant< T... > & node, std::pmr::memory_resource * resource )
+	{
+		switch( val )
+		{
+		case bson::element_type::null_node:
+			node = element< element_type::null_node >();
+			break;
+		case bson::element_type::int32_node:
 			node = element< element_type::int32_node >();
 			break;
 		case bson::element_type::int64_node:
 			node = element< element_type::int64_node >();
 			break;
 		case bson::element_type::array_node:
-			node = element< element_type::array_node >();
+			node = element< element_type::array_node >( resource );
 			break;
 		case bson::element_type::double_node:
 			node = element< element_type::double_node >();
 			break;
 		case bson::element_type::string_node:
-			node = element< element_type::string_node >();
+			node = element< element_type::string_node >( resource );
 			break;
 		case bson::element_type::binary_node:
-			node = element< element_type::binary_node >();
+			node = element< element_type::binary_node >( resource );
 			break;
 		case bson::element_type::boolean_node:
 			node = element< element_type::boolean_node >();
@@ -2056,13 +3950,13 @@ namespace bson
 			node = element< element_type::max_key_node >();
 			break;
 		case bson::element_type::regular_node:
-			node = element< element_type::regular_node >();
+			node = element< element_type::regular_node >( resource );
 			break;
 		case bson::element_type::datetime_node:
 			node = element< element_type::datetime_node >();
 			break;
 		case bson::element_type::document_node:
-			node = element< element_type::document_node >();
+			node = element< element_type::document_node >( resource );
 			break;
 		case bson::element_type::timestamp_node:
 			node = element< element_type::timestamp_node >();
@@ -2071,325 +3965,2694 @@ namespace bson
 			node = element< element_type::object_id_node >();
 			break;
 		default:
-			throw std::runtime_error( "bson::type unknown" );
-			break;
+			throw std::runtime_error( "bson::type unknown" );
+			break;
+		}
+	}
+	template< typename ... T > element_type get_node_type( const std::variant< T... > & node )
+	{
+		return std::visit( overloaded
+						   {
+							   []( const std::monostate & val ) { return element_type::unknown_node; },
+							   []( const element< element_type::null_node > & val ) { return val.get_type(); },
+							   []( const element< element_type::int32_node > & val ) { return val.get_type(); },
+							   []( const element< element_type::int64_node > & val ) { return val.get_type(); },
+							   []( const element< element_type::array_node > & val ) { return val.get_type(); },
+							   []( const element< element_type::double_node > & val ) { return val.get_type(); },
+							   []( const element< element_type::string_node > & val ) { return val.get_type(); },
+							   []( const element< element_type::binary_node > & val ) { return val.get_type(); },
+							   []( const element< element_type::boolean_node > & val ) { return val.get_type(); },
+							   []( const element< element_type::min_key_node > & val ) { return val.get_type(); },
+							   []( const element< element_type::max_key_node > & val ) { return val.get_type(); },
+							   []( const element< element_type::regular_node > & val ) { return val.get_type(); },
+							   []( const element< element_type::datetime_node > & val ) { return val.get_type(); },
+							   []( const element< element_type::document_node > & val ) { return val.get_type(); },
+							   []( const element< element_type::timestamp_node > & val ) { return val.get_type(); },
+							   []( const element< element_type::object_id_node > & val ) { return val.get_type(); },
+						   }, node );
+	}
+	template< typename ... T > std::size_t get_node_size( const std::variant< T... > & node )
+	{
+		return std::visit( overloaded
+						   {
+							   []( const std::monostate & val ) ->std::size_t { return 0; },
+							   []( const element< element_type::null_node > & val ) { return val.get_size(); },
+							   []( const element< element_type::int32_node > & val ) { return val.get_size(); },
+							   []( const element< element_type::int64_node > & val ) { return val.get_size(); },
+							   []( const element< element_type::array_node > & val ) { return val.get_size(); },
+							   []( const element< element_type::double_node > & val ) { return val.get_size(); },
+							   []( const element< element_type::string_node > & val ) { return val.get_size(); },
+							   []( const element< element_type::binary_node > & val ) { return val.get_size(); },
+							   []( const element< element_type::boolean_node > & val ) { return val.get_size(); },
+							   []( const element< element_type::min_key_node > & val ) { return val.get_size(); },
+							   []( const element< element_type::max_key_node > & val ) { return val.get_size(); },
+							   []( const element< element_type::regular_node > & val ) { return val.get_size(); },
+							   []( const element< element_type::datetime_node > & val ) { return val.get_size(); },
+							   []( const element< element_type::document_node > & val ) { return val.get_size(); },
+							   []( const element< element_type::timestamp_node > & val ) { return val.get_size(); },
+							   []( const element< element_type::object_id_node > & val ) { return val.get_size(); },
+						   }, node );
+	}
+	template< typename ... T > void node_deserialize( std::istream & is, std::variant< T... > & node, std::pmr::memory_resource * resource )
+	{
+		if( node.index() == 0 )
+		{
+			node = element<element_type::document_node>( resource );
+		}
+
+		std::visit( overloaded
+					{
+						[&]( std::monostate & val ){},
+						[&]( element< element_type::null_node > & val ) { val.deserialize( is ); },
+						[&]( element< element_type::int32_node > & val ) { val.deserialize( is ); },
+						[&]( element< element_type::int64_node > & val ) { val.deserialize( is ); },
+						[&]( element< element_type::array_node > & val ) { val.deserialize( is ); },
+						[&]( element< element_type::double_node > & val ) { val.deserialize( is ); },
+						[&]( element< element_type::string_node > & val ) { val.deserialize( is ); },
+						[&]( element< element_type::binary_node > & val ) { val.deserialize( is ); },
+						[&]( element< element_type::boolean_node > & val ) { val.deserialize( is ); },
+						[&]( element< element_type::min_key_node > & val ) { val.deserialize( is ); },
+						[&]( element< element_type::max_key_node > & val ) { val.deserialize( is ); },
+						[&]( element< element_type::regular_node > & val ) { val.deserialize( is ); },
+						[&]( element< element_type::datetime_node > & val ) { val.deserialize( is ); },
+						[&]( element< element_type::document_node > & val ) { val.deserialize( is ); },
+						[&]( element< element_type::timestamp_node > & val ) { val.deserialize( is ); },
+						[&]( element< element_type::object_id_node > & val ) { val.deserialize( is ); },
+					}, node );
+	}
+	template< typename ... T > void node_deserialize( const value_view & val, std::variant< T... > & node, std::pmr::memory_resource * resource )
+	{
+		switch( val.get_type() )
+		{
+		case bson::element_type::null_node:
+			node = element< element_type::null_node >();
+			break;
+		case bson::element_type::int32_node:
+			node = element< element_type::int32_node >( val.get_int32() );
+			break;
+		case bson::element_type::int64_node:
+			node = element< element_type::int64_node >( val.get_int64() );
+			break;
+		case bson::element_type::array_node:
+		{
+			auto arr = element< element_type::array_node >( resource );
+			arr.deserialize( val.get_array() );
+			node = std::move( arr );
+		}
+		break;
+		case bson::element_type::double_node:
+			node = element< element_type::double_node >( val.get_double() );
+			break;
+		case bson::element_type::string_node:
+			node = element< element_type::string_node >( val.get_string(), resource );
+			break;
+		case bson::element_type::binary_node:
+			node = element< element_type::binary_node >( val.get_binary(), val.get_binary_type(), resource );
+			break;
+		case bson::element_type::boolean_node:
+			node = element< element_type::boolean_node >( val.get_boolean() );
+			break;
+		case bson::element_type::min_key_node:
+			node = element< element_type::min_key_node >();
+			break;
+		case bson::element_type::max_key_node:
+			node = element< element_type::max_key_node >();
+			break;
+		case bson::element_type::regular_node:
+			node = element< element_type::regular_node >( val.get_pattern(), val.get_options(), resource );
+			break;
+		case bson::element_type::datetime_node:
+			node = element< element_type::datetime_node >( val.get_datetime() );
+			break;
+		case bson::element_type::document_node:
+		{
+			auto doc = element< element_type::document_node >( resource );
+			doc.deserialize( val.get_document() );
+			node = std::move( doc );
+		}
+		break;
+		case bson::element_type::timestamp_node:
+			node = element< element_type::timestamp_node >( val.get_timestamp() );
+			break;
+		case bson::element_type::object_id_node:
+			node = element< element_type::object_id_node >( val.get_object_id() );
+			break;
+		default:
+			throw std::runtime_error( "bson::type unknown" );
+			break;
+		}
+	}
+	template< typename ... T > void node_serialize( std::ostream & os, const std::variant< T... > & node )
+	{
+		std::visit( overloaded
+					{
+						[&]( const std::monostate & val ) {},
+						[&]( const element< element_type::null_node > & val ) { val.serialize( os ); },
+						[&]( const element< element_type::int32_node > & val ) { val.serialize( os ); },
+						[&]( const element< element_type::int64_node > & val ) { val.serialize( os ); },
+						[&]( const element< element_type::array_node > & val ) { val.serialize( os ); },
+						[&]( const element< element_type::double_node > & val ) { val.serialize( os ); },
+						[&]( const element< element_type::string_node > & val ) { val.serialize( os ); },
+						[&]( const element< element_type::binary_node > & val ) { val.serialize( os ); },
+						[&]( const element< element_type::boolean_node > & val ) { val.serialize( os ); },
+						[&]( const element< element_type::min_key_node > & val ) { val.serialize( os ); },
+						[&]( const element< element_type::max_key_node > & val ) { val.serialize( os ); },
+						[&]( const element< element_type::regular_node > & val ) { val.serialize( os ); },
+						[&]( const element< element_type::datetime_node > & val ) { val.serialize( os ); },
+						[&]( const element< element_type::document_node > & val ) { val.serialize( os ); },
+						[&]( const element< element_type::timestamp_node > & val ) { val.serialize( os ); },
+						[&]( const element< element_type::object_id_node > & val ) { val.serialize( os ); },
+					}, node );
+	}
+	template< typename ... T > char * node_serialize( char * dst, const std::variant< T... > & node )
+	{
+		return std::visit( overloaded
+						   {
+							   [&]( const std::monostate & val ) { return dst; },
+							   [&]( const element< element_type::null_node > & val ) { return val.serialize( dst ); },
+							   [&]( const element< element_type::int32_node > & val ) { return val.serialize( dst ); },
+							   [&]( const element< element_type::int64_node > & val ) { return val.serialize( dst ); },
+							   [&]( const element< element_type::array_node > & val ) { return val.serialize( dst ); },
+							   [&]( const element< element_type::double_node > & val ) { return val.serialize( dst ); },
+							   [&]( const element< element_type::string_node > & val ) { return val.serialize( dst ); },
+							   [&]( const element< element_type::binary_node > & val ) { return val.serialize( dst ); },
+							   [&]( const element< element_type::boolean_node > & val ) { return val.serialize( dst ); },
+							   [&]( const element< element_type::min_key_node > & val ) { return val.serialize( dst ); },
+							   [&]( const element< element_type::max_key_node > & val ) { return val.serialize( dst ); },
+							   [&]( const element< element_type::regular_node > & val ) { return val.serialize( dst ); },
+							   [&]( const element< element_type::datetime_node > & val ) { return val.serialize( dst ); },
+							   [&]( const element< element_type::document_node > & val ) { return val.serialize( dst ); },
+							   [&]( const element< element_type::timestamp_node > & val ) { return val.serialize( dst ); },
+							   [&]( const element< element_type::object_id_node > & val ) { return val.serialize( dst ); },
+						   }, node );
+	}
+	template< typename ... T > void node_to_json( std::ostream & os, const std::variant< T... > & node )
+	{
+		std::visit( overloaded
+					{
+						[&os]( const std::monostate & val ) {},
+						[&os]( const element< element_type::null_node > & val ) { val.to_json( os ); },
+						[&os]( const element< element_type::int32_node > & val ) { val.to_json( os ); },
+						[&os]( const element< element_type::int64_node > & val ) { val.to_json( os ); },
+						[&os]( const element< element_type::array_node > & val ) { val.to_json( os ); },
+						[&os]( const element< element_type::double_node > & val ) { val.to_json( os ); },
+						[&os]( const element< element_type::string_node > & val ) { val.to_json( os ); },
+						[&os]( const element< element_type::binary_node > & val ) { os << R"({ "$binary" : )"; val.to_json( os ); os << " }"; },
+						[&os]( const element< element_type::boolean_node > & val ) { val.to_json( os ); },
+						[&os]( const element< element_type::min_key_node > & val ) { os << R"({ "$minKey" : )"; val.to_json( os ); os << " }"; },
+						[&os]( const element< element_type::max_key_node > & val ) { os << R"({ "$maxKey" : )"; val.to_json( os ); os << " }"; },
+						[&os]( const element< element_type::regular_node > & val ) { os << R"({ "$regularExpression" : )"; val.to_json( os ); os << " }"; },
+						[&os]( const element< element_type::datetime_node > & val ) { os << R"({ "$date" : )"; val.to_json( os ); os << " }"; },
+						[&os]( const element< element_type::document_node > & val ) { val.to_json( os ); },
+						[&os]( const element< element_type::timestamp_node > & val ) { os << R"({ "$timestamp" : )"; val.to_json( os ); os << " }"; },
+						[&os]( const element< element_type::object_id_node > & val ) { os << R"({ "$oid" : )"; val.to_json( os ); os << " }"; },
+					}, node );
+	}
+	template< typename S, typename ... T > void node_from_json( S & is, std::variant< T... > & node, std::pmr::memory_resource * resource )
+	{
+		switch( speek( is ) )
+		{
+		case '\"':
+		{
+			auto elem = element< element_type::string_node >( resource );
+
+			elem.from_json( is );
+
+			if( elem.get_value().front() == '$' )
+			{
+				if( is.eof() || sget( is ) != ':' )
+				{
+					throw std::runtime_error( "template< typename S, typename ... T > void node_from_json( S & is, std::variant< T... > & node )" );
+				}
+
+				if( elem.get_value() == "$oid" )
+				{
+					auto oid = element< element_type::object_id_node >();
+					oid.from_json( is );
+					node = std::move( oid );
+				}
+				else if( elem.get_value() == "$date" )
+				{
+					auto date = element< element_type::datetime_node >();
+					date.from_json( is );
+					node = std::move( date );
+				}
+				else if( elem.get_value() == "$numberDouble" )
+				{
+					auto dou = element< element_type::double_node >();
+					dou.from_json( is );
+					node = std::move( dou );
+				}
+				else if( elem.get_value() == "$minKey" )
+				{
+					auto min = element< element_type::min_key_node >();
+					min.from_json( is );
+					node = std::move( min );
+				}
+				else if( elem.get_value() == "$maxKey" )
+				{
+					auto max = element< element_type::max_key_node >();
+					max.from_json( is );
+					node = std::move( max );
+				}
+				else if( elem.get_value() == "$timestamp" )
+				{
+					auto time = element< element_type::timestamp_node >();
+					time.from_json( is );
+					node = std::move( time );
+				}
+				else if( elem.get_value() == "$binary" )
+				{
+					auto time = element< element_type::binary_node >( resource );
+					time.from_json( is );
+					node = std::move( time );
+				}
+				else if( elem.get_value() == "$regularExpression" )
+				{
+					auto reg = element< element_type::regular_node >( resource );
+					reg.from_json( is );
+					node = std::move( reg );
+				}
+				else
+				{
+					throw std::runtime_error( "template< typename S, typename ... T > void node_from_json( S & is, std::variant< T... > & node )" );
+				}
+			}
+			else if( elem.get_value() == "NaN" )
+			{
+				node = element<element_type::double_node>( std::numeric_limits<double>::quiet_NaN() );
+			}
+			else if( elem.get_value() == "Infinity" )
+			{
+				node = element<element_type::double_node>( std::numeric_limits<double>::infinity() );
+			}
+			else if( elem.get_value() == "-Infinity" )
+			{
+				node = element<element_type::double_node>( -std::numeric_limits<double>::infinity() );
+			}
+			else
+			{
+				node = std::move( elem );
+			}
+		}
+		break;
+		case '{':
+		{
+			auto pos = is.tellg();
+
+			if( sget( is ) == '{' && sget( is ) == '\"' && sget( is ) == '$' )
+			{
+				pos += 1;
+				is.seekg( pos );
+
+				node_from_json( is, node, resource );
+
+				if( !smatch( is, "}" ) )
+				{
+					throw std::runtime_error( "template< typename S, typename ... T > void node_from_json( S & is, std::variant< T... > & node )" );
+				}
+			}
+			else
+			{
+				is.seekg( pos );
+
+				auto doc = element< element_type::document_node >( resource );
+				doc.from_json( is );
+				node = std::move( doc );
+			}
+		}
+		break;
+		case '[':
+		{
+			auto arr = element< element_type::array_node >( resource );
+			arr.from_json( is );
+			node = std::move( arr );
+		}
+		break;
+		case 'n':
+		{
+			auto elem = element<element_type::null_node>();
+			elem.from_json( is );
+			node = std::move( elem );
+		}
+		break;
+		case 't':
+		case 'f':
+		{
+			auto elem = element<element_type::boolean_node>();
+			elem.from_json( is );
+			node = std::move( elem );
+		}
+		break;
+		default:
+			if( !is.eof() && ( speek( is ) >= '0' && speek( is ) <= '9' ) || speek( is ) == '.' || speek( is ) == '-' )
+			{
+				char buf[64];
+
+				auto num = snumber( is, buf, sizeof( buf ) );
+
+				if( num.find_first_of( ".eE" ) != std::string_view::npos )
+				{
+					node = std::move( element< element_type::double_node >( parse_number< double >( num ) ) );
+				}
+				else
+				{
+					std::int64_t n = parse_number< std::int64_t >( num );
+					if( n > std::numeric_limits<std::int32_t>::max() ||
+						n < std::numeric_limits<std::int32_t>::min() )
+					{
+						node = std::move( element< element_type::int64_node >( n ) );
+					}
+					else
+					{
+						node = std::move( element< element_type::int32_node >( static_cast<std::int32_t>( n ) ) );
+					}
+				}
+			}
+			else
+			{
+				throw std::runtime_error( "template< typename S, typename ... T > void node_from_json( S & is, std::variant< T... > & node )" );
+			}
+			break;
+		}
+	}
+
+	template< typename S > void json_to_bson_document( S & is, std::vector<char> & out );
+	template< typename S > void json_to_bson_array( S & is, std::vector<char> & out );
+
+	template< typename S > void json_to_bson_expect( S & is, std::string_view token )
+	{
+		if( !smatch( is, token ) )
+		{
+			throw std::runtime_error( "template< typename S > void json_to_bson_expect( S & is, std::string_view token )" );
+		}
+	}
+	template< typename S > std::string_view json_to_bson_quoted( S & is, char * buf, std::size_t size )
+	{
+		std::size_t len = 0;
+
+		json_to_bson_expect( is, "\"" );
+		for( int c = is.get(); c != '\"'; c = is.get() )
+		{
+			if( c == std::char_traits<char>::eof() || len == size )
+			{
+				throw std::runtime_error( "template< typename S > std::string_view json_to_bson_quoted( S & is, char * buf, std::size_t size )" );
+			}
+
+			buf[len++] = static_cast<char>( c );
+		}
+
+		return { buf, len };
+	}
+	template< typename T, typename S > void json_to_bson_number( S & is, std::vector<char> & out )
+	{
+		char buf[64];
+
+		T val = parse_number< T >( snumber( is, buf, sizeof( buf ) ) );
+
+		std::size_t pos = out.size();
+		out.resize( pos + sizeof( T ) );
+		raw_store( out.data() + pos, val );
+	}
+	template< typename S > void json_to_bson_cstring( S & is, std::vector<char> & out )
+	{
+		if( sget( is ) != '\"' )
+		{
+			throw std::runtime_error( "template< typename S > void json_to_bson_cstring( S & is, std::vector<char> & out )" );
+		}
+
+		sappend( is, '\"', out );
+		out.push_back( 0 );
+
+		if( is.get() != '\"' )
+		{
+			throw std::runtime_error( "template< typename S > void json_to_bson_cstring( S & is, std::vector<char> & out )" );
+		}
+	}
+	template< typename S > element_type json_to_bson_extended( S & is, std::vector<char> & out )
+	{
+		char name[24]; std::size_t len = 0;
+
+		if( sget( is ) != '{' || sget( is ) != '\"' )
+		{
+			throw std::runtime_error( "template< typename S > element_type json_to_bson_extended( S & is, std::vector<char> & out )" );
+		}
+		for( int c = is.get(); c != '\"'; c = is.get() )
+		{
+			if( c == std::char_traits<char>::eof() || len == sizeof( name ) )
+			{
+				throw std::runtime_error( "template< typename S > element_type json_to_bson_extended( S & is, std::vector<char> & out )" );
+			}
+
+			name[len++] = static_cast<char>( c );
+		}
+		if( sget( is ) != ':' )
+		{
+			throw std::runtime_error( "template< typename S > element_type json_to_bson_extended( S & is, std::vector<char> & out )" );
+		}
+
+		element_type type = element_type::unknown_node;
+		std::string_view key( name, len );
+
+		if( key == "$oid" )
+		{
+			char buf[32];
+
+			auto hex = json_to_bson_quoted( is, buf, sizeof( buf ) );
+			if( hex.size() != 24 )
+			{
+				throw std::runtime_error( "template< typename S > element_type json_to_bson_extended( S & is, std::vector<char> & out )" );
+			}
+
+			std::size_t pos = out.size();
+			out.resize( pos + 12 );
+			hex_decode( out.data() + pos, hex.data(), hex.size() );
+
+			type = element_type::object_id_node;
+		}
+		else if( key == "$date" )
+		{
+			char buf[32];
+
+			std::int64_t val = parse_datetime( json_to_bson_quoted( is, buf, sizeof( buf ) ) );
+
+			std::size_t pos = out.size();
+			out.resize( pos + sizeof( std::int64_t ) );
+			raw_store( out.data() + pos, val );
+
+			type = element_type::datetime_node;
+		}
+		else if( key == "$numberDouble" )
+		{
+			if( speek( is ) == '\"' )
+			{
+				char buf[64];
+
+				auto str = json_to_bson_quoted( is, buf, sizeof( buf ) );
+
+				double val = str == "NaN" ? std::numeric_limits<double>::quiet_NaN() : str == "Infinity" ? std::numeric_limits<double>::infinity() : str == "-Infinity" ? -std::numeric_limits<double>::infinity() : parse_number< double >( str );
+
+				std::size_t pos = out.size();
+				out.resize( pos + sizeof( double ) );
+				raw_store( out.data() + pos, val );
+			}
+			else
+			{
+				json_to_bson_number< double >( is, out );
+			}
+
+			type = element_type::double_node;
+		}
+		else if( key == "$minKey" )
+		{
+			json_to_bson_expect( is, "1" );
+
+			type = element_type::min_key_node;
+		}
+		else if( key == "$maxKey" )
+		{
+			json_to_bson_expect( is, "1" );
+
+			type = element_type::max_key_node;
+		}
+		else if( key == "$timestamp" )
+		{
+			json_to_bson_expect( is, R"({"t":)" );
+			json_to_bson_number< std::uint64_t >( is, out );
+			json_to_bson_expect( is, R"(,"i":1})" );
+
+			type = element_type::timestamp_node;
+		}
+		else if( key == "$binary" && smatch( is, R"({"base64":")" ) )
+		{
+			std::size_t pos = out.size();
+			out.resize( pos + sizeof( std::int32_t ) + sizeof( binary_type ) );
+
+			// the text lands behind the header and is decoded in place, the output never overtakes the input
+			std::size_t text = out.size();
+			sappend( is, '\"', out );
+			out.resize( base64_decode( out.data() + text, out.data() + text, out.size() - text ) - out.data() );
+
+			char buf[8]; std::size_t sub = 0;
+			if( !smatch( is, R"(","subType":")" ) )
+			{
+				throw std::runtime_error( "template< typename S > element_type json_to_bson_extended( S & is, std::vector<char> & out )" );
+			}
+			for( int c = is.get(); c != '\"'; c = is.get() )
+			{
+				if( c == std::char_traits<char>::eof() || sub == sizeof( buf ) )
+				{
+					throw std::runtime_error( "template< typename S > element_type json_to_bson_extended( S & is, std::vector<char> & out )" );
+				}
+
+				buf[sub++] = static_cast<char>( c );
+			}
+
+			unsigned int btype = 0;
+			auto result = std::from_chars( buf, buf + sub, btype, 16 );
+			if( result.ec != std::errc() || result.ptr != buf + sub || !smatch( is, "}" ) )
+			{
+				throw std::runtime_error( "template< typename S > element_type json_to_bson_extended( S & is, std::vector<char> & out )" );
+			}
+
+			raw_store( out.data() + pos, static_cast<std::int32_t>( out.size() - text ) );
+			raw_store( out.data() + pos + sizeof( std::int32_t ), static_cast<binary_type>( btype ) );
+
+			type = element_type::binary_node;
+		}
+		else if( key == "$regularExpression" && smatch( is, R"({"pattern":)" ) )
+		{
+			json_to_bson_cstring( is, out );
+
+			if( !smatch( is, R"(,"options":)" ) )
+			{
+				throw std::runtime_error( "template< typename S > element_type json_to_bson_extended( S & is, std::vector<char> & out )" );
+			}
+
+			json_to_bson_cstring( is, out );
+
+			if( !smatch( is, "}" ) )
+			{
+				throw std::runtime_error( "template< typename S > element_type json_to_bson_extended( S & is, std::vector<char> & out )" );
+			}
+
+			type = element_type::regular_node;
+		}
+
+		if( type == element_type::unknown_node || !smatch( is, "}" ) )
+		{
+			throw std::runtime_error( "template< typename S > element_type json_to_bson_extended( S & is, std::vector<char> & out )" );
+		}
+
+		return type;
+	}
+	template< typename S > element_type json_to_bson_value( S & is, std::vector<char> & out )
+	{
+		switch( speek( is ) )
+		{
+		case '\"':
+		{
+			std::size_t pos = out.size();
+			out.resize( pos + sizeof( std::int32_t ) );
+
+			json_to_bson_cstring( is, out );
+
+			std::string_view str( out.data() + pos + sizeof( std::int32_t ), out.size() - pos - sizeof( std::int32_t ) - 1 );
+			if( str == "NaN" || str == "Infinity" || str == "-Infinity" )
+			{
+				double val = str == "NaN" ? std::numeric_limits<double>::quiet_NaN() : str == "Infinity" ? std::numeric_limits<double>::infinity() : -std::numeric_limits<double>::infinity();
+
+				out.resize( pos + sizeof( double ) );
+				raw_store( out.data() + pos, val );
+
+				return element_type::double_node;
+			}
+
+			raw_store( out.data() + pos, static_cast<std::int32_t>( str.size() + 1 ) );
+
+			return element_type::string_node;
+		}
+		case '{':
+		{
+			auto pos = is.tellg();
+
+			bool extended = sget( is ) == '{' && sget( is ) == '\"' && sget( is ) == '$';
+
+			is.seekg( pos );
+
+			if( extended )
+			{
+				return json_to_bson_extended( is, out );
+			}
+
+			json_to_bson_document( is, out );
+
+			return element_type::document_node;
+		}
+		case '[':
+			json_to_bson_array( is, out );
+			return element_type::array_node;
+		case 'n':
+			json_to_bson_expect( is, "null" );
+			return element_type::null_node;
+		case 't':
+			json_to_bson_expect( is, "true" );
+			out.push_back( 1 );
+			return element_type::boolean_node;
+		case 'f':
+			json_to_bson_expect( is, "false" );
+			out.push_back( 0 );
+			return element_type::boolean_node;
+		default:
+		{
+			char buf[64];
+
+			auto num = snumber( is, buf, sizeof( buf ) );
+			if( num.empty() )
+			{
+				throw std::runtime_error( "template< typename S > element_type json_to_bson_value( S & is, std::vector<char> & out )" );
+			}
+
+			std::size_t pos = out.size();
+			if( num.find_first_of( ".eE" ) != std::string_view::npos )
+			{
+				out.resize( pos + sizeof( double ) );
+				raw_store( out.data() + pos, parse_number< double >( num ) );
+
+				return element_type::double_node;
+			}
+
+			std::int64_t n = parse_number< std::int64_t >( num );
+			if( n > std::numeric_limits<std::int32_t>::max() || n < std::numeric_limits<std::int32_t>::min() )
+			{
+				out.resize( pos + sizeof( std::int64_t ) );
+				raw_store( out.data() + pos, n );
+
+				return element_type::int64_node;
+			}
+
+			out.resize( pos + sizeof( std::int32_t ) );
+			raw_store( out.data() + pos, static_cast<std::int32_t>( n ) );
+
+			return element_type::int32_node;
+		}
+		}
+	}
+	template< typename S > void json_to_bson_document( S & is, std::vector<char> & out )
+	{
+		std::size_t beg = out.size();
+		out.resize( beg + sizeof( std::int32_t ) );
+
+		if( sget( is ) != '{' )
+		{
+			throw std::runtime_error( "template< typename S > void json_to_bson_document( S & is, std::vector<char> & out )" );
+		}
+
+		for( int c = speek( is ) == '}' ? sget( is ) : ','; c != '}'; c = sget( is ) )
+		{
+			if( c != ',' )
+			{
+				throw std::runtime_error( "template< typename S > void json_to_bson_document( S & is, std::vector<char> & out )" );
+			}
+
+			std::size_t type = out.size();
+			out.push_back( 0 );
+
+			json_to_bson_cstring( is, out );
+
+			if( sget( is ) != ':' )
+			{
+				throw std::runtime_error( "template< typename S > void json_to_bson_document( S & is, std::vector<char> & out )" );
+			}
+
+			out[type] = static_cast<char>( json_to_bson_value( is, out ) );
+		}
+
+		out.push_back( 0 );
+
+		raw_store( out.data() + beg, static_cast<std::int32_t>( out.size() - beg ) );
+	}
+	template< typename S > void json_to_bson_array( S & is, std::vector<char> & out )
+	{
+		std::size_t beg = out.size();
+		out.resize( beg + sizeof( std::int32_t ) );
+
+		if( sget( is ) != '[' )
+		{
+			throw std::runtime_error( "template< typename S > void json_to_bson_array( S & is, std::vector<char> & out )" );
+		}
+
+		std::size_t i = 0;
+		for( int c = speek( is ) == ']' ? sget( is ) : ','; c != ']'; c = sget( is ), i++ )
+		{
+			if( c != ',' )
+			{
+				throw std::runtime_error( "template< typename S > void json_to_bson_array( S & is, std::vector<char> & out )" );
+			}
+
+			std::size_t type = out.size();
+			out.push_back( 0 );
+
+			char buf[20];
+			auto key = array_key( i, buf );
+			out.insert( out.end(), key.begin(), key.end() );
+			out.push_back( 0 );
+
+			out[type] = static_cast<char>( json_to_bson_value( is, out ) );
+		}
+
+		out.push_back( 0 );
+
+		raw_store( out.data() + beg, static_cast<std::int32_t>( out.size() - beg ) );
+	}
+
+	// appends the document straight to out, lengths are reserved and patched once each subtree closes
+	inline void json_to_bson( std::istream & is, std::vector<char> & out )
+	{
+		json_to_bson_document( is, out );
+	}
+	inline void json_to_bson( json_reader & is, std::vector<char> & out )
+	{
+		json_to_bson_document( is, out );
+	}
+	inline void json_to_bson( std::string_view json, std::vector<char> & out )
+	{
+		json_reader is( json );
+
+		json_to_bson_document( is, out );
+	}
+
+	using null_t = element< element_type::null_node >;
+	using int32_t = element< element_type::int32_node >;
+	using int64_t = element< element_type::int64_node >;
+	using array_t = element< element_type::array_node >;
+	using double_t = element< element_type::double_node >;
+	using string_t = element< element_type::string_node >;
+	using binary_t = element< element_type::binary_node >;
+	using boolean_t = element< element_type::boolean_node >;
+	using min_key_t = element< element_type::min_key_node >;
+	using max_key_t = element< element_type::max_key_node >;
+	using regular_t = element< element_type::regular_node >;
+	using datetime_t = element< element_type::datetime_node >;
+	using document_t = element< element_type::document_node >;
+	using timestamp_t = element< element_type::timestamp_node >;
+	using object_id_t = element< element_type::object_id_node >;
+
+	using node_t = std::variant< 
+		std::monostate,
+		null_t,
+		int32_t,
+		int64_t,
+		array_t,
+		double_t,
+		string_t,
+		binary_t,
+		boolean_t,
+		min_key_t,
+		max_key_t,
+		regular_t,
+		datetime_t,
+		document_t,
+		timestamp_t,
+		object_id_t
+	>;
+
+	// a dotted path split once, numeric segments also address array elements
+	class path
+	{
+	public:
+		path() = default;
+
+		explicit path( std::string_view val )
+		{
+			while( true )
+			{
+				auto pos = val.find( '.' );
+				auto key = val.substr( 0, pos );
+
+				// "03" is never an array index, array keys are written without leading zeros
+				std::size_t index = key.empty() || ( key.size() > 1 && key[0] == '0' ) ? npos : 0;
+				for( char c : key )
+				{
+					if( c < '0' || c > '9' || index > ( npos - 9 ) / 10 )
+					{
+						index = npos;
+						break;
+					}
+
+					index = index * 10 + ( c - '0' );
+				}
+
+				segments.push_back( { std::string( key ), index } );
+
+				if( pos == std::string_view::npos )
+				{
+					break;
+				}
+
+				val.remove_prefix( pos + 1 );
+			}
+		}
+
+	public:
+		const node_t * find( const document_t & doc ) const
+		{
+			const node_t * node = nullptr;
+			const document_t * cur_doc = &doc;
+			const array_t * cur_arr = nullptr;
+
+			for( const auto & seg : segments )
+			{
+				if( cur_doc != nullptr )
+				{
+					auto it = cur_doc->find( seg.key );
+					if( it == cur_doc->end() )
+					{
+						return nullptr;
+					}
+
+					node = &it->second;
+				}
+				else if( cur_arr != nullptr && seg.index < cur_arr->size() )
+				{
+					node = &( *cur_arr )[seg.index];
+				}
+				else
+				{
+					return nullptr;
+				}
+
+				cur_doc = std::get_if< document_t >( node );
+				cur_arr = std::get_if< array_t >( node );
+			}
+
+			return node;
+		}
+
+		std::optional< value_view > find( const document_view & doc ) const
+		{
+			if( segments.empty() )
+			{
+				return std::nullopt;
+			}
+
+			value_view cur( element_type::document_node, doc.get_data(), doc.get_size() );
+
+			for( const auto & seg : segments )
+			{
+				if( cur.get_type() != element_type::document_node && cur.get_type() != element_type::array_node )
+				{
+					return std::nullopt;
+				}
+
+				// array keys are the decimal indices, so both containers are searched the same way
+				bool found = false;
+				for( const auto & it : document_view( cur.get_data(), cur.get_size() ) )
+				{
+					if( it.first == seg.key )
+					{
+						cur = it.second;
+						found = true;
+						break;
+					}
+				}
+
+				if( !found )
+				{
+					return std::nullopt;
+				}
+			}
+
+			return cur;
+		}
+
+		std::optional< value_view > find( const char * data, std::size_t size ) const
+		{
+			return find( document_view( data, size ) );
+		}
+
+		// like find, also recording where each matched element starts (its type byte) and its value, outermost first
+		bool trace( const document_view & doc, std::vector< std::pair< const char *, value_view > > & trail ) const
+		{
+			trail.clear();
+
+			if( segments.empty() )
+			{
+				return false;
+			}
+
+			value_view cur( element_type::document_node, doc.get_data(), doc.get_size() );
+
+			for( const auto & seg : segments )
+			{
+				if( cur.get_type() != element_type::document_node && cur.get_type() != element_type::array_node )
+				{
+					return false;
+				}
+
+				bool found = false;
+				for( const auto & it : document_view( cur.get_data(), cur.get_size() ) )
+				{
+					if( it.first == seg.key )
+					{
+						trail.emplace_back( it.first.data() - 1, it.second );
+						cur = it.second;
+						found = true;
+						break;
+					}
+				}
+
+				if( !found )
+				{
+					return false;
+				}
+			}
+
+			return true;
+		}
+
+	public:
+		bool empty() const
+		{
+			return segments.empty();
+		}
+
+		std::size_t size() const
+		{
+			return segments.size();
+		}
+
+	private:
+		static constexpr std::size_t npos = static_cast<std::size_t>( -1 );
+
+		struct segment
+		{
+			std::string key;
+			std::size_t index;
+		};
+
+		std::vector< segment > segments;
+	};
+
+	// overwrites a fixed-width value in place, fails when the path is missing or holds another type
+	template< typename T > bool update( char * data, std::size_t size, const path & where, const T & val )
+	{
+		static_assert( std::is_same_v< T, int32_t > || std::is_same_v< T, int64_t > || std::is_same_v< T, double_t > || std::is_same_v< T, boolean_t > ||
+					   std::is_same_v< T, datetime_t > || std::is_same_v< T, timestamp_t > || std::is_same_v< T, object_id_t >, "update only rewrites fixed-width values" );
+
+		auto found = where.find( data, size );
+		if( !found || found->get_type() != val.get_type() )
+		{
+			return false;
+		}
+
+		val.serialize( data + ( found->get_data() - data ) );
+
+		return true;
+	}
+
+	// replaces the value at where with any node, shifting the tail and fixing the length of every enclosing document
+	inline bool splice( std::vector<char> & buf, const path & where, const node_t & val )
+	{
+		if( std::holds_alternative< std::monostate >( val ) )
+		{
+			throw std::runtime_error( "inline bool splice( std::vector<char> & buf, const path & where, const node_t & val )" );
+		}
+
+		std::vector< std::pair< const char *, value_view > > trail;
+		if( !where.trace( document_view( buf.data(), buf.size() ), trail ) )
+		{
+			return false;
+		}
+
+		std::size_t type = trail.back().first - buf.data();
+		std::size_t beg = trail.back().second.get_data() - buf.data();
+		std::size_t old_size = trail.back().second.get_size();
+		std::size_t new_size = get_node_size( val );
+
+		std::vector< std::size_t > parents( 1, 0 );
+		for( std::size_t i = 0; i + 1 < trail.size(); i++ )
+		{
+			parents.push_back( trail[i].second.get_data() - buf.data() );
+		}
+
+		if( new_size > old_size )
+		{
+			buf.insert( buf.begin() + beg + old_size, new_size - old_size, 0 );
+		}
+		else
+		{
+			buf.erase( buf.begin() + beg + new_size, buf.begin() + beg + old_size );
+		}
+
+		node_serialize( buf.data() + beg, val );
+		buf[type] = static_cast<char>( get_node_type( val ) );
+
+		for( auto it : parents )
+		{
+			std::int64_t sz = raw_load< std::int32_t >( buf.data() + it ) + static_cast<std::int64_t>( new_size ) - static_cast<std::int64_t>( old_size );
+
+			raw_store( buf.data() + it, static_cast<std::int32_t>( sz ) );
+		}
+
+		return true;
+	}
+
+	// perfect hash over a key set fixed at compile time, a lookup costs one hash and one compare
+	template< std::size_t N > class key_switch
+	{
+	public:
+		static constexpr std::size_t npos = static_cast<std::size_t>( -1 );
+
+	public:
+		constexpr key_switch( const std::array< std::string_view, N > & keys )
+			:keys( keys )
+		{
+			static_assert( N < 255, "key_switch supports at most 254 keys" );
+
+			// length and three sampled bytes usually separate field names, whole keys are the fallback
+			for( mode = 0; mode < 2; mode++ )
+			{
+				for( seed = 1; seed <= 256; seed++ )
+				{
+					if( place() )
+					{
+						return;
+					}
+				}
+			}
+
+			throw std::runtime_error( "constexpr key_switch( const std::array< std::string_view, N > & keys )" );
 		}
+
+	public:
+		constexpr std::size_t find( std::string_view key ) const
+		{
+			std::size_t slot = slots[hash( key )];
+
+			return slot != 0 && keys[slot - 1] == key ? slot - 1 : npos;
+		}
+
+	private:
+		constexpr bool place()
+		{
+			for( auto & it : slots )
+			{
+				it = 0;
+			}
+
+			for( std::size_t i = 0; i < N; i++ )
+			{
+				auto & slot = slots[hash( keys[i] )];
+				if( slot != 0 )
+				{
+					return false;
+				}
+
+				slot = static_cast<std::uint8_t>( i + 1 );
+			}
+
+			return true;
+		}
+
+		constexpr std::size_t hash( std::string_view key ) const
+		{
+			std::uint32_t h = seed ^ static_cast<std::uint32_t>( key.size() );
+
+			if( mode == 0 )
+			{
+				if( !key.empty() )
+				{
+					h = ( h ^ static_cast<unsigned char>( key.front() ) ) * 0x01000193u;
+					h = ( h ^ static_cast<unsigned char>( key[key.size() / 2] ) ) * 0x01000193u;
+					h = ( h ^ static_cast<unsigned char>( key.back() ) ) * 0x01000193u;
+				}
+			}
+			else
+			{
+				for( char c : key )
+				{
+					h = ( h ^ static_cast<unsigned char>( c ) ) * 0x01000193u;
+				}
+			}
+
+			return ( h ^ ( h >> 15 ) ) & ( capacity - 1 );
+		}
+
+	private:
+		static constexpr std::size_t capacity = []()
+		{
+			std::size_t result = 8;
+			while( result < N * 8 )
+			{
+				result *= 2;
+			}
+			return result;
+		}();
+
+		std::array< std::string_view, N > keys;
+		std::array< std::uint8_t, capacity > slots = {};
+		std::uint32_t seed = 0;
+		int mode = 0;
+	};
+
+	// field mapping for user types, see BSON_DEFINE_FIELDS; encode returns the element type it wrote
+	template< typename T > struct traits;
+
+	template< typename T > void raw_append( std::vector<char> & out, const T & val )
+	{
+		std::size_t pos = out.size();
+		out.resize( pos + sizeof( T ) );
+		raw_store( out.data() + pos, val );
 	}
-	template< typename ... T > element_type get_node_type( const std::variant< T... > & node )
+
+	template<> struct traits< bool >
 	{
-		return std::visit( overloaded
-						   {
-							   []( const std::monostate & val ) { return element_type::unknown_node; },
-							   []( const element< element_type::null_node > & val ) { return val.get_type(); },
-							   []( const element< element_type::int32_node > & val ) { return val.get_type(); },
-							   []( const element< element_type::int64_node > & val ) { return val.get_type(); },
-							   []( const element< element_type::array_node > & val ) { return val.get_type(); },
-							   []( const element< element_type::double_node > & val ) { return val.get_type(); },
-							   []( const element< element_type::string_node > & val ) { return val.get_type(); },
-							   []( const element< element_type::binary_node > & val ) { return val.get_type(); },
-							   []( const element< element_type::boolean_node > & val ) { return val.get_type(); },
-							   []( const element< element_type::min_key_node > & val ) { return val.get_type(); },
-							   []( const element< element_type::max_key_node > & val ) { return val.get_type(); },
-							   []( const element< element_type::regular_node > & val ) { return val.get_type(); },
-							   []( const element< element_type::datetime_node > & val ) { return val.get_type(); },
-							   []( const element< element_type::document_node > & val ) { return val.get_type(); },
-							   []( const element< element_type::timestamp_node > & val ) { return val.get_type(); },
-							   []( const element< element_type::object_id_node > & val ) { return val.get_type(); },
-						   }, node );
+		static element_type encode( std::vector<char> & out, bool val )
+		{
+			out.push_back( val ? 1 : 0 );
+
+			return element_type::boolean_node;
+		}
+
+		static void decode( const value_view & val, bool & out )
+		{
+			if( val.get_type() != element_type::boolean_node )
+			{
+				throw std::runtime_error( "static void traits< bool >::decode( const value_view & val, bool & out )" );
+			}
+
+			out = val.get_boolean();
+		}
+	};
+	template<> struct traits< std::int32_t >
+	{
+		static element_type encode( std::vector<char> & out, std::int32_t val )
+		{
+			raw_append( out, val );
+
+			return element_type::int32_node;
+		}
+
+		static void decode( const value_view & val, std::int32_t & out )
+		{
+			if( val.get_type() != element_type::int32_node )
+			{
+				throw std::runtime_error( "static void traits< std::int32_t >::decode( const value_view & val, std::int32_t & out )" );
+			}
+
+			out = val.get_int32();
+		}
+	};
+	template<> struct traits< std::int64_t >
+	{
+		static element_type encode( std::vector<char> & out, std::int64_t val )
+		{
+			raw_append( out, val );
+
+			return element_type::int64_node;
+		}
+
+		static void decode( const value_view & val, std::int64_t & out )
+		{
+			switch( val.get_type() )
+			{
+			case element_type::int32_node:
+				out = val.get_int32();
+				break;
+			case element_type::int64_node:
+				out = val.get_int64();
+				break;
+			default:
+				throw std::runtime_error( "static void traits< std::int64_t >::decode( const value_view & val, std::int64_t & out )" );
+			}
+		}
+	};
+	template<> struct traits< double >
+	{
+		static element_type encode( std::vector<char> & out, double val )
+		{
+			raw_append( out, val );
+
+			return element_type::double_node;
+		}
+
+		static void decode( const value_view & val, double & out )
+		{
+			switch( val.get_type() )
+			{
+			case element_type::int32_node:
+				out = val.get_int32();
+				break;
+			case element_type::int64_node:
+				out = static_cast<double>( val.get_int64() );
+				break;
+			case element_type::double_node:
+				out = val.get_double();
+				break;
+			default:
+				throw std::runtime_error( "static void traits< double >::decode( const value_view & val, double & out )" );
+			}
+		}
+	};
+	template<> struct traits< float >
+	{
+		static element_type encode( std::vector<char> & out, float val )
+		{
+			return traits< double >::encode( out, val );
+		}
+
+		static void decode( const value_view & val, float & out )
+		{
+			double result = 0;
+
+			traits< double >::decode( val, result );
+
+			out = static_cast<float>( result );
+		}
+	};
+	template<> struct traits< std::string >
+	{
+		static element_type encode( std::vector<char> & out, const std::string & val )
+		{
+			raw_append( out, static_cast<std::int32_t>( val.size() + 1 ) );
+			out.insert( out.end(), val.c_str(), val.c_str() + val.size() + 1 );
+
+			return element_type::string_node;
+		}
+
+		static void decode( const value_view & val, std::string & out )
+		{
+			if( val.get_type() != element_type::string_node )
+			{
+				throw std::runtime_error( "static void traits< std::string >::decode( const value_view & val, std::string & out )" );
+			}
+
+			out.assign( val.get_string() );
+		}
+	};
+	template<> struct traits< std::string_view >
+	{
+		static element_type encode( std::vector<char> & out, std::string_view val )
+		{
+			raw_append( out, static_cast<std::int32_t>( val.size() + 1 ) );
+			out.insert( out.end(), val.begin(), val.end() );
+			out.push_back( 0 );
+
+			return element_type::string_node;
+		}
+
+		// the result points into the decoded bytes
+		static void decode( const value_view & val, std::string_view & out )
+		{
+			if( val.get_type() != element_type::string_node )
+			{
+				throw std::runtime_error( "static void traits< std::string_view >::decode( const value_view & val, std::string_view & out )" );
+			}
+
+			out = val.get_string();
+		}
+	};
+	template<> struct traits< std::nullptr_t >
+	{
+		static element_type encode( std::vector<char> &, std::nullptr_t )
+		{
+			return element_type::null_node;
+		}
+
+		static void decode( const value_view &, std::nullptr_t & )
+		{
+
+		}
+	};
+	template< typename Duration > struct traits< std::chrono::time_point< std::chrono::system_clock, Duration > >
+	{
+		using time_point = std::chrono::time_point< std::chrono::system_clock, Duration >;
+
+		static element_type encode( std::vector<char> & out, const time_point & val )
+		{
+			raw_append( out, static_cast<std::int64_t>( std::chrono::duration_cast< std::chrono::milliseconds >( val.time_since_epoch() ).count() ) );
+
+			return element_type::datetime_node;
+		}
+
+		static void decode( const value_view & val, time_point & out )
+		{
+			if( val.get_type() != element_type::datetime_node )
+			{
+				throw std::runtime_error( "static void traits< time_point >::decode( const value_view & val, time_point & out )" );
+			}
+
+			out = time_point( std::chrono::duration_cast< Duration >( std::chrono::milliseconds( val.get_datetime() ) ) );
+		}
+	};
+	template< typename T > struct traits< std::optional< T > >
+	{
+		// an empty optional is null inside arrays, as a field it is left out entirely
+		static element_type encode( std::vector<char> & out, const std::optional< T > & val )
+		{
+			return val ? traits< T >::encode( out, *val ) : element_type::null_node;
+		}
+
+		static void decode( const value_view & val, std::optional< T > & out )
+		{
+			if( val.get_type() == element_type::null_node )
+			{
+				out.reset();
+			}
+			else
+			{
+				traits< T >::decode( val, out.emplace() );
+			}
+		}
+	};
+	template< typename T > struct traits< std::vector< T > >
+	{
+		static element_type encode( std::vector<char> & out, const std::vector< T > & val )
+		{
+			std::size_t beg = out.size();
+			out.resize( beg + sizeof( std::int32_t ) );
+
+			for( std::size_t i = 0; i < val.size(); i++ )
+			{
+				std::size_t type = out.size();
+				out.push_back( 0 );
+
+				char buf[20];
+				auto key = array_key( i, buf );
+				out.insert( out.end(), key.begin(), key.end() );
+				out.push_back( 0 );
+
+				out[type] = static_cast<char>( traits< T >::encode( out, val[i] ) );
+			}
+
+			out.push_back( 0 );
+
+			raw_store( out.data() + beg, static_cast<std::int32_t>( out.size() - beg ) );
+
+			return element_type::array_node;
+		}
+
+		static void decode( const value_view & val, std::vector< T > & out )
+		{
+			if( val.get_type() != element_type::array_node )
+			{
+				throw std::runtime_error( "static void traits< std::vector< T > >::decode( const value_view & val, std::vector< T > & out )" );
+			}
+
+			out.clear();
+			for( const auto & it : val.get_array() )
+			{
+				traits< T >::decode( it.second, out.emplace_back() );
+			}
+		}
+	};
+
+	template< typename C, typename M > struct field
+	{
+		std::string_view name;
+		M C:: * member;
+	};
+	template< typename C, typename M > constexpr field< C, M > make_field( std::string_view name, M C:: * member )
+	{
+		return { name, member };
 	}
-	template< typename ... T > std::size_t get_node_size( const std::variant< T... > & node )
+
+	template< typename T > void encode_field( std::vector<char> & out, std::string_view name, const T & val )
 	{
-		return std::visit( overloaded
-						   {
-							   []( const std::monostate & val ) ->std::size_t { return 0; },
-							   []( const element< element_type::null_node > & val ) { return val.get_size(); },
-							   []( const element< element_type::int32_node > & val ) { return val.get_size(); },
-							   []( const element< element_type::int64_node > & val ) { return val.get_size(); },
-							   []( const element< element_type::array_node > & val ) { return val.get_size(); },
-							   []( const element< element_type::double_node > & val ) { return val.get_size(); },
-							   []( const element< element_type::string_node > & val ) { return val.get_size(); },
-							   []( const element< element_type::binary_node > & val ) { return val.get_size(); },
-							   []( const element< element_type::boolean_node > & val ) { return val.get_size(); },
-							   []( const element< element_type::min_key_node > & val ) { return val.get_size(); },
-							   []( const element< element_type::max_key_node > & val ) { return val.get_size(); },
-							   []( const element< element_type::regular_node > & val ) { return val.get_size(); },
-							   []( const element< element_type::datetime_node > & val ) { return val.get_size(); },
-							   []( const element< element_type::document_node > & val ) { return val.get_size(); },
-							   []( const element< element_type::timestamp_node > & val ) { return val.get_size(); },
-							   []( const element< element_type::object_id_node > & val ) { return val.get_size(); },
-						   }, node );
+		std::size_t type = out.size();
+		out.push_back( 0 );
+
+		out.insert( out.end(), name.begin(), name.end() );
+		out.push_back( 0 );
+
+		out[type] = static_cast<char>( traits< T >::encode( out, val ) );
+	}
+	template< typename T > void encode_field( std::vector<char> & out, std::string_view name, const std::optional< T > & val )
+	{
+		if( val )
+		{
+			encode_field( out, name, *val );
+		}
+	}
+
+	// base of the traits generated by BSON_DEFINE_FIELDS, members missing from the bytes keep their value
+	template< typename T > struct struct_traits
+	{
+		static element_type encode( std::vector<char> & out, const T & val )
+		{
+			std::size_t beg = out.size();
+			out.resize( beg + sizeof( std::int32_t ) );
+
+			std::apply( [&]( const auto & ... fields ) { ( encode_field( out, fields.name, val.*fields.member ), ... ); }, traits< T >::fields() );
+
+			out.push_back( 0 );
+
+			raw_store( out.data() + beg, static_cast<std::int32_t>( out.size() - beg ) );
+
+			return element_type::document_node;
+		}
+
+		static void decode( const value_view & val, T & out )
+		{
+			if( val.get_type() != element_type::document_node )
+			{
+				throw std::runtime_error( "static void struct_traits< T >::decode( const value_view & val, T & out )" );
+			}
+
+			decode_fields( val, out, std::make_index_sequence< std::tuple_size_v< decltype( traits< T >::fields() ) > >() );
+		}
+
+	private:
+		template< std::size_t ... I > static void decode_fields( const value_view & val, T & out, std::index_sequence< I... > )
+		{
+			static constexpr key_switch< sizeof...( I ) > keys( { std::get< I >( traits< T >::fields() ).name... } );
+			static constexpr void ( * handlers[] )( const value_view &, T & ) = { &decode_field< I >... };
+
+			for( const auto & it : val.get_document() )
+			{
+				std::size_t i = keys.find( it.first );
+				if( i != keys.npos )
+				{
+					handlers[i]( it.second, out );
+				}
+			}
+		}
+
+		template< std::size_t I > static void decode_field( const value_view & val, T & out )
+		{
+			auto & member = out.*std::get< I >( traits< T >::fields() ).member;
+
+			traits< std::decay_t< decltype( member ) > >::decode( val, member );
+		}
+	};
+
+	template< typename T > void encode( const T & val, std::vector<char> & out )
+	{
+		traits< T >::encode( out, val );
 	}
-	template< typename ... T > void node_deserialize( std::istream & is, std::variant< T... > & node )
+	template< typename T > void decode( const document_view & doc, T & val )
 	{
-		if( node.index() == 0 )
+		traits< T >::decode( value_view( element_type::document_node, doc.get_data(), doc.get_size() ), val );
+	}
+	template< typename T > void decode( const char * data, std::size_t size, T & val )
+	{
+		decode( document_view( data, size ), val );
+	}
+
+	// writes wire bytes as values arrive, every open document or array keeps the offset of its length until close()
+	class builder
+	{
+	public:
+		builder()
+		{
+			clear();
+		}
+
+	public:
+		template< typename T > builder & append( std::string_view key, const T & val )
+		{
+			if( stack.empty() )
+			{
+				throw std::runtime_error( "builder & append( std::string_view key, const T & val )" );
+			}
+
+			encode_field( buffer, key, val );
+
+			return *this;
+		}
+
+		builder & append( std::string_view key, const char * val )
+		{
+			return append( key, std::string_view( val ) );
+		}
+
+		template< typename T > builder & push_back( const T & val )
+		{
+			char buf[20];
+
+			return append( next_key( buf ), val );
+		}
+
+		// unlike a field, an array element cannot be left out without renumbering the rest
+		template< typename T > builder & push_back( const std::optional< T > & val )
+		{
+			if( val )
+			{
+				return push_back( *val );
+			}
+
+			char buf[20];
+
+			return append( next_key( buf ), nullptr );
+		}
+
+		builder & push_back( const char * val )
+		{
+			return push_back( std::string_view( val ) );
+		}
+
+		builder & open_document( std::string_view key )
+		{
+			return open( key, element_type::document_node );
+		}
+
+		builder & open_document()
+		{
+			char buf[20];
+
+			return open( next_key( buf ), element_type::document_node );
+		}
+
+		builder & open_array( std::string_view key )
+		{
+			return open( key, element_type::array_node );
+		}
+
+		builder & open_array()
+		{
+			char buf[20];
+
+			return open( next_key( buf ), element_type::array_node );
+		}
+
+		builder & close()
+		{
+			if( stack.size() <= 1 )
+			{
+				throw std::runtime_error( "builder & close()" );
+			}
+
+			seal();
+
+			return *this;
+		}
+
+	public:
+		// closes the root document, the view stays valid until the builder is cleared or destroyed
+		document_view finish()
+		{
+			if( stack.size() != 1 )
+			{
+				throw std::runtime_error( "document_view finish()" );
+			}
+
+			seal();
+
+			return { buffer.data(), buffer.size() };
+		}
+
+		void clear()
+		{
+			buffer.clear();
+			stack.clear();
+
+			stack.push_back( { 0, npos } );
+			buffer.resize( sizeof( std::int32_t ) );
+		}
+
+		const std::vector<char> & get_buffer() const
+		{
+			return buffer;
+		}
+
+	private:
+		builder & open( std::string_view key, element_type type )
+		{
+			if( stack.empty() )
+			{
+				throw std::runtime_error( "builder & open( std::string_view key, element_type type )" );
+			}
+
+			buffer.push_back( static_cast<char>( type ) );
+			buffer.insert( buffer.end(), key.begin(), key.end() );
+			buffer.push_back( 0 );
+
+			stack.push_back( { buffer.size(), type == element_type::array_node ? 0 : npos } );
+			buffer.resize( buffer.size() + sizeof( std::int32_t ) );
+
+			return *this;
+		}
+
+		void seal()
+		{
+			buffer.push_back( 0 );
+
+			raw_store( buffer.data() + stack.back().first, static_cast<std::int32_t>( buffer.size() - stack.back().first ) );
+
+			stack.pop_back();
+		}
+
+		std::string_view next_key( char * buf )
+		{
+			if( stack.empty() || stack.back().second == npos )
+			{
+				throw std::runtime_error( "std::string_view next_key( char * buf )" );
+			}
+
+			return array_key( stack.back().second++, buf );
+		}
+
+	private:
+		static constexpr std::size_t npos = static_cast<std::size_t>( -1 );
+
+		std::vector<char> buffer;
+		// offset of each open length prefix, and the next index when it belongs to an array
+		std::vector< std::pair< std::size_t, std::size_t > > stack;
+	};
+
+	// flat alternative to document_t: 16 byte cells over one copy of the encoded bytes,
+	// the children of every document and array are contiguous cells
+	class compact_document
+	{
+	public:
+		struct span
+		{
+			std::uint32_t first;
+			std::uint32_t size;
+		};
+
+		struct cell
+		{
+			element_type type;
+			binary_type subtype;
+			std::uint16_t key_size;
+			std::uint32_t key;
+			// strings, binaries, regexes and object ids are spans of the arena, documents and arrays spans of cells
+			union
+			{
+				std::int32_t int32;
+				std::int64_t int64;
+				double dbl;
+				bool boolean;
+				std::uint64_t timestamp;
+				span data;
+				span children;
+			};
+		};
+
+		static_assert( sizeof( cell ) == 16, "compact_document::cell must stay 16 bytes" );
+
+	public:
+		compact_document() = default;
+
+		explicit compact_document( const document_view & view )
+		{
+			deserialize( view );
+		}
+
+	public:
+		std::size_t size() const
+		{
+			return root.size;
+		}
+
+		bool empty() const
+		{
+			return root.size == 0;
+		}
+
+		const cell * begin() const
+		{
+			return cells.data() + root.first;
+		}
+
+		const cell * end() const
+		{
+			return cells.data() + root.first + root.size;
+		}
+
+		cell * begin()
+		{
+			return cells.data() + root.first;
+		}
+
+		cell * end()
+		{
+			return cells.data() + root.first + root.size;
+		}
+
+		const cell * begin( const cell & val ) const
+		{
+			assert( ( val.type == element_type::document_node || val.type == element_type::array_node ) && "const cell * begin( const cell & val ) const" );
+
+			return cells.data() + val.children.first;
+		}
+
+		const cell * end( const cell & val ) const
+		{
+			assert( ( val.type == element_type::document_node || val.type == element_type::array_node ) && "const cell * end( const cell & val ) const" );
+
+			return cells.data() + val.children.first + val.children.size;
+		}
+
+		cell * begin( const cell & val )
+		{
+			return const_cast<cell *>( static_cast<const compact_document *>( this )->begin( val ) );
+		}
+
+		cell * end( const cell & val )
+		{
+			return const_cast<cell *>( static_cast<const compact_document *>( this )->end( val ) );
+		}
+
+		const cell * find( std::string_view key ) const
+		{
+			return find( begin(), end(), key );
+		}
+
+		const cell * find( const cell & val, std::string_view key ) const
+		{
+			return find( begin( val ), end( val ), key );
+		}
+
+		cell * find( std::string_view key )
+		{
+			return const_cast<cell *>( static_cast<const compact_document *>( this )->find( key ) );
+		}
+
+		cell * find( const cell & val, std::string_view key )
+		{
+			return const_cast<cell *>( static_cast<const compact_document *>( this )->find( val, key ) );
+		}
+
+	public:
+		std::string_view get_key( const cell & val ) const
+		{
+			return { arena.data() + val.key, val.key_size };
+		}
+
+		std::string_view get_string( const cell & val ) const
+		{
+			assert( val.type == element_type::string_node && "std::string_view get_string( const cell & val ) const" );
+
+			return { arena.data() + val.data.first, val.data.size };
+		}
+
+		std::string_view get_binary( const cell & val ) const
+		{
+			assert( val.type == element_type::binary_node && "std::string_view get_binary( const cell & val ) const" );
+
+			return { arena.data() + val.data.first, val.data.size };
+		}
+
+		std::string_view get_pattern( const cell & val ) const
+		{
+			assert( val.type == element_type::regular_node && "std::string_view get_pattern( const cell & val ) const" );
+
+			return arena.data() + val.data.first;
+		}
+
+		std::string_view get_options( const cell & val ) const
+		{
+			assert( val.type == element_type::regular_node && "std::string_view get_options( const cell & val ) const" );
+
+			return arena.data() + val.data.first + get_pattern( val ).size() + 1;
+		}
+
+		std::array<char, 12> get_object_id( const cell & val ) const
+		{
+			assert( val.type == element_type::object_id_node && "std::array<char, 12> get_object_id( const cell & val ) const" );
+
+			std::array<char, 12> result;
+
+			std::memcpy( result.data(), arena.data() + val.data.first, result.size() );
+
+			return result;
+		}
+
+	public:
+		void set_string( cell & val, std::string_view str )
+		{
+			val.type = element_type::string_node;
+			val.data = append( str.data(), str.size() );
+		}
+
+		void set_binary( cell & val, std::string_view bin, binary_type type = binary_type::binary )
+		{
+			val.type = element_type::binary_node;
+			val.subtype = type;
+			val.data = append( bin.data(), bin.size() );
+		}
+
+	public:
+		void deserialize( const document_view & view )
+		{
+			arena.assign( view.get_data(), view.get_data() + view.get_size() );
+			cells.clear();
+
+			root = reserve( document_view( arena.data(), arena.size() ) );
+
+			index( root.first, document_view( arena.data(), arena.size() ) );
+		}
+
+		std::size_t get_size() const
+		{
+			return compute_size( root );
+		}
+
+		void serialize_to( std::vector<char> & buf ) const
+		{
+			std::size_t pos = buf.size();
+
+			buf.resize( pos + get_size() );
+
+			serialize( buf.data() + pos, root );
+		}
+
+	private:
+		const cell * find( const cell * beg, const cell * end, std::string_view key ) const
+		{
+			for( ; beg != end; ++beg )
+			{
+				if( beg->key_size == key.size() && std::memcmp( arena.data() + beg->key, key.data(), key.size() ) == 0 )
+				{
+					return beg;
+				}
+			}
+
+			return nullptr;
+		}
+
+		span append( const char * data, std::size_t size )
+		{
+			// set values go past the copied bytes, terminated like the encoded strings
+			span result = { static_cast<std::uint32_t>( arena.size() ), static_cast<std::uint32_t>( size ) };
+
+			arena.insert( arena.end(), data, data + size );
+			arena.push_back( 0 );
+
+			return result;
+		}
+
+		span reserve( const document_view & view )
+		{
+			std::size_t count = 0;
+			for( auto it = view.begin(); it != view.end(); ++it )
+			{
+				count++;
+			}
+
+			span result = { static_cast<std::uint32_t>( cells.size() ), static_cast<std::uint32_t>( count ) };
+
+			cells.resize( cells.size() + count );
+
+			return result;
+		}
+
+		void index( std::size_t first, const document_view & view )
+		{
+			for( const auto & it : view )
+			{
+				if( it.first.size() > std::numeric_limits< std::uint16_t >::max() )
+				{
+					throw std::out_of_range( "void compact_document::index( std::size_t first, const document_view & view )" );
+				}
+
+				const value_view & val = it.second;
+				std::size_t i = first++;
+				std::uint32_t offset = static_cast<std::uint32_t>( val.get_data() - arena.data() );
+
+				cells[i].type = val.get_type();
+				cells[i].subtype = binary_type::binary;
+				cells[i].key_size = static_cast<std::uint16_t>( it.first.size() );
+				cells[i].key = static_cast<std::uint32_t>( it.first.data() - arena.data() );
+				cells[i].int64 = 0;
+
+				switch( val.get_type() )
+				{
+				case element_type::int32_node:
+					cells[i].int32 = val.get_int32();
+					break;
+				case element_type::int64_node:
+				case element_type::datetime_node:
+					cells[i].int64 = raw_load< std::int64_t >( val.get_data() );
+					break;
+				case element_type::double_node:
+					cells[i].dbl = val.get_double();
+					break;
+				case element_type::boolean_node:
+					cells[i].boolean = val.get_boolean();
+					break;
+				case element_type::timestamp_node:
+					cells[i].timestamp = val.get_timestamp();
+					break;
+				case element_type::string_node:
+					cells[i].data = { offset + static_cast<std::uint32_t>( sizeof( std::int32_t ) ), static_cast<std::uint32_t>( val.get_string().size() ) };
+					break;
+				case element_type::binary_node:
+					cells[i].subtype = val.get_binary_type();
+					cells[i].data = { offset + static_cast<std::uint32_t>( sizeof( std::int32_t ) + sizeof( binary_type ) ), static_cast<std::uint32_t>( val.get_binary().size() ) };
+					break;
+				case element_type::regular_node:
+				case element_type::object_id_node:
+					cells[i].data = { offset, static_cast<std::uint32_t>( val.get_size() ) };
+					break;
+				case element_type::document_node:
+				case element_type::array_node:
+				{
+					document_view sub( val.get_data(), val.get_size() );
+
+					span children = reserve( sub );
+
+					cells[i].children = children;
+
+					index( children.first, sub );
+				}
+				break;
+				default:
+					break;
+				}
+			}
+		}
+
+		std::size_t compute_size( span children ) const
 		{
-			node = element<element_type::document_node>();
+			std::size_t result = sizeof( std::int32_t ) + 1;
+
+			for( std::size_t i = children.first; i < children.first + children.size; i++ )
+			{
+				const cell & val = cells[i];
+
+				result += 1 + val.key_size + 1;
+
+				switch( val.type )
+				{
+				case element_type::int32_node:
+					result += sizeof( std::int32_t );
+					break;
+				case element_type::int64_node:
+				case element_type::double_node:
+				case element_type::datetime_node:
+				case element_type::timestamp_node:
+					result += sizeof( std::int64_t );
+					break;
+				case element_type::boolean_node:
+					result += 1;
+					break;
+				case element_type::string_node:
+					result += sizeof( std::int32_t ) + val.data.size + 1;
+					break;
+				case element_type::binary_node:
+					result += sizeof( std::int32_t ) + sizeof( binary_type ) + val.data.size;
+					break;
+				case element_type::regular_node:
+				case element_type::object_id_node:
+					result += val.data.size;
+					break;
+				case element_type::document_node:
+				case element_type::array_node:
+					result += compute_size( val.children );
+					break;
+				default:
+					break;
+				}
+			}
+
+			return result;
 		}
 
-		std::visit( overloaded
-					{
-						[&]( std::monostate & val ){},
-						[&]( element< element_type::null_node > & val ) { val.deserialize( is ); },
-						[&]( element< element_type::int32_node > & val ) { val.deserialize( is ); },
-						[&]( element< element_type::int64_node > & val ) { val.deserialize( is ); },
-						[&]( element< element_type::array_node > & val ) { val.deserialize( is ); },
-						[&]( element< element_type::double_node > & val ) { val.deserialize( is ); },
-						[&]( element< element_type::string_node > & val ) { val.deserialize( is ); },
-						[&]( element< element_type::binary_node > & val ) { val.deserialize( is ); },
-						[&]( element< element_type::boolean_node > & val ) { val.deserialize( is ); },
-						[&]( element< element_type::min_key_node > & val ) { val.deserialize( is ); },
-						[&]( element< element_type::max_key_node > & val ) { val.deserialize( is ); },
-						[&]( element< element_type::regular_node > & val ) { val.deserialize( is ); },
-						[&]( element< element_type::datetime_node > & val ) { val.deserialize( is ); },
-						[&]( element< element_type::document_node > & val ) { val.deserialize( is ); },
-						[&]( element< element_type::timestamp_node > & val ) { val.deserialize( is ); },
-						[&]( element< element_type::object_id_node > & val ) { val.deserialize( is ); },
-					}, node );
-	}
-	template< typename ... T > void node_serialize( std::ostream & os, const std::variant< T... > & node )
-	{
-		std::visit( overloaded
-					{
-						[&]( const std::monostate & val ) {},
-						[&]( const element< element_type::null_node > & val ) { val.serialize( os ); },
-						[&]( const element< element_type::int32_node > & val ) { val.serialize( os ); },
-						[&]( const element< element_type::int64_node > & val ) { val.serialize( os ); },
-						[&]( const element< element_type::array_node > & val ) { val.serialize( os ); },
-						[&]( const element< element_type::double_node > & val ) { val.serialize( os ); },
-						[&]( const element< element_type::string_node > & val ) { val.serialize( os ); },
-						[&]( const element< element_type::binary_node > & val ) { val.serialize( os ); },
-						[&]( const element< element_type::boolean_node > & val ) { val.serialize( os ); },
-						[&]( const element< element_type::min_key_node > & val ) { val.serialize( os ); },
-						[&]( const element< element_type::max_key_node > & val ) { val.serialize( os ); },
-						[&]( const element< element_type::regular_node > & val ) { val.serialize( os ); },
-						[&]( const element< element_type::datetime_node > & val ) { val.serialize( os ); },
-						[&]( const element< element_type::document_node > & val ) { val.serialize( os ); },
-						[&]( const element< element_type::timestamp_node > & val ) { val.serialize( os ); },
-						[&]( const element< element_type::object_id_node > & val ) { val.serialize( os ); },
-					}, node );
-	}
-	template< typename ... T > void node_to_json( std::ostream & os, const std::variant< T... > & node )
+		char * serialize( char * dst, span children ) const
+		{
+			char * beg = dst;
+
+			dst += sizeof( std::int32_t );
+
+			for( std::size_t i = children.first; i < children.first + children.size; i++ )
+			{
+				const cell & val = cells[i];
+
+				*dst++ = static_cast<char>( val.type );
+				std::memcpy( dst, arena.data() + val.key, val.key_size );
+				dst += val.key_size;
+				*dst++ = 0;
+
+				switch( val.type )
+				{
+				case element_type::int32_node:
+					dst = raw_store( dst, val.int32 );
+					break;
+				case element_type::int64_node:
+				case element_type::datetime_node:
+					dst = raw_store( dst, val.int64 );
+					break;
+				case element_type::double_node:
+					dst = raw_store( dst, val.dbl );
+					break;
+				case element_type::boolean_node:
+					*dst++ = val.boolean ? 1 : 0;
+					break;
+				case element_type::timestamp_node:
+					dst = raw_store( dst, val.timestamp );
+					break;
+				case element_type::string_node:
+					dst = raw_store( dst, static_cast<std::int32_t>( val.data.size + 1 ) );
+					std::memcpy( dst, arena.data() + val.data.first, val.data.size );
+					dst += val.data.size;
+					*dst++ = 0;
+					break;
+				case element_type::binary_node:
+					dst = raw_store( dst, static_cast<std::int32_t>( val.data.size ) );
+					dst = raw_store( dst, val.subtype );
+					std::memcpy( dst, arena.data() + val.data.first, val.data.size );
+					dst += val.data.size;
+					break;
+				case element_type::regular_node:
+				case element_type::object_id_node:
+					std::memcpy( dst, arena.data() + val.data.first, val.data.size );
+					dst += val.data.size;
+					break;
+				case element_type::document_node:
+				case element_type::array_node:
+					dst = serialize( dst, val.children );
+					break;
+				default:
+					break;
+				}
+			}
+
+			*dst++ = 0;
+
+			raw_store( beg, static_cast<std::int32_t>( dst - beg ) );
+
+			return dst;
+		}
+
+	private:
+		span root = { 0, 0 };
+		std::vector< cell > cells;
+		// a copy of the decoded bytes, keys and values point into it; values set later are appended
+		std::vector< char > arena;
+	};
+
+	class stream_reader
 	{
-		std::visit( overloaded
+	public:
+		explicit stream_reader( std::istream & is, std::size_t capacity = 1 << 20 )
+			:stream( &is ), buffer( capacity )
+		{
+
+		}
+
+		explicit stream_reader( int fd, std::size_t capacity = 1 << 20 )
+			:handle( fd ), buffer( capacity )
+		{
+
+		}
+
+	public:
+		bool next( document_view & doc )
+		{
+			if( !fill( sizeof( std::int32_t ) ) )
+			{
+				return false;
+			}
+
+			std::int32_t sz = raw_load< std::int32_t >( buffer.data() + beg );
+			if( sz < 5 || !fill( static_cast<std::size_t>( sz ) ) )
+			{
+				throw std::out_of_range( "bool next( document_view & doc )" );
+			}
+
+			doc = document_view( buffer.data() + beg, static_cast<std::size_t>( sz ) );
+
+			beg += static_cast<std::size_t>( sz );
+
+			return true;
+		}
+
+		bool next( document_t & doc )
+		{
+			document_view view;
+			if( !next( view ) )
+			{
+				return false;
+			}
+
+			doc = document_t( doc.get_resource() );
+			doc.deserialize( view );
+
+			return true;
+		}
+
+	private:
+		bool fill( std::size_t size )
+		{
+			if( end - beg >= size )
+			{
+				return true;
+			}
+
+			std::memmove( buffer.data(), buffer.data() + beg, end - beg );
+			end -= beg;
+			beg = 0;
+
+			while( end < size )
+			{
+				// grow with the bytes actually read, an untrusted length prefix must not size the buffer up front
+				if( end == buffer.size() )
+				{
+					buffer.resize( std::min( size, std::max< std::size_t >( buffer.size() * 2, 4096 ) ) );
+				}
+
+				std::size_t count = read( buffer.data() + end, buffer.size() - end );
+				if( count == 0 )
+				{
+					if( end == 0 )
 					{
-						[&os]( const std::monostate & val ) {},
-						[&os]( const element< element_type::null_node > & val ) { val.to_json( os ); },
-						[&os]( const element< element_type::int32_node > & val ) { val.to_json( os ); },
-						[&os]( const element< element_type::int64_node > & val ) { val.to_json( os ); },
-						[&os]( const element< element_type::array_node > & val ) { val.to_json( os ); },
-						[&os]( const element< element_type::double_node > & val ) { val.to_json( os ); },
-						[&os]( const element< element_type::string_node > & val ) { val.to_json( os ); },
-						[&os]( const element< element_type::binary_node > & val ) { os << R"({ "$binary" : )"; val.to_json( os ); os << " }"; },
-						[&os]( const element< element_type::boolean_node > & val ) { val.to_json( os ); },
-						[&os]( const element< element_type::min_key_node > & val ) { os << R"({ "$minKey" : )"; val.to_json( os ); os << " }"; },
-						[&os]( const element< element_type::max_key_node > & val ) { os << R"({ "$maxKey" : )"; val.to_json( os ); os << " }"; },
-						[&os]( const element< element_type::regular_node > & val ) { os << R"({ "$regularExpression" : )"; val.to_json( os ); os << " }"; },
-						[&os]( const element< element_type::datetime_node > & val ) { os << R"({ "$date" : )"; val.to_json( os ); os << " }"; },
-						[&os]( const element< element_type::document_node > & val ) { val.to_json( os ); },
-						[&os]( const element< element_type::timestamp_node > & val ) { os << R"({ "$timestamp" : )"; val.to_json( os ); os << " }"; },
-						[&os]( const element< element_type::object_id_node > & val ) { os << R"({ "$oid" : )"; val.to_json( os ); os << " }"; },
-					}, node );
-	}
-	template< typename ... T > void node_from_json( std::istream & is, std::variant< T... > & node )
+						return false;
+					}
+
+					throw std::out_of_range( "bool fill( std::size_t size )" );
+				}
+
+				end += count;
+			}
+
+			return true;
+		}
+
+		std::size_t read( char * dst, std::size_t size )
+		{
+			if( stream != nullptr )
+			{
+				stream->read( dst, size );
+
+				return static_cast<std::size_t>( stream->gcount() );
+			}
+
+#ifdef WIN32
+			auto count = _read( handle, dst, static_cast<unsigned int>( size ) );
+#else
+			auto count = ::read( handle, dst, size );
+#endif // WIN32
+			if( count < 0 )
+			{
+				throw std::runtime_error( "std::size_t read( char * dst, std::size_t size )" );
+			}
+
+			return static_cast<std::size_t>( count );
+		}
+
+	private:
+		std::istream * stream = nullptr;
+		int handle = -1;
+		std::vector<char> buffer;
+		// unread bytes are buffer[beg, end), a document view stays valid until the next call
+		std::size_t beg = 0, end = 0;
+	};
+
+	class mapped_file
 	{
-		switch( speek( is ) )
+	public:
+		mapped_file() = default;
+
+		explicit mapped_file( const std::string & path, const std::string & index_path = {} )
 		{
-		case '\"':
+			map( path );
+
+			if( index_path.empty() || !load_index( index_path ) )
+			{
+				build_index();
+
+				if( !index_path.empty() )
+				{
+					save_index( index_path );
+				}
+			}
+		}
+
+		mapped_file( mapped_file && val ) noexcept
+		{
+			swap( val );
+		}
+
+		mapped_file( const mapped_file & ) = delete;
+
+		mapped_file & operator =( mapped_file && val ) noexcept
+		{
+			swap( val );
+
+			return *this;
+		}
+
+		mapped_file & operator =( const mapped_file & ) = delete;
+
+		~mapped_file()
+		{
+			unmap();
+		}
+
+	public:
+		void swap( mapped_file & val )
+		{
+			std::swap( data, val.data );
+			std::swap( size, val.size );
+			std::swap( offsets, val.offsets );
+#ifdef WIN32
+			std::swap( mapping, val.mapping );
+#endif // WIN32
+		}
+
+	public:
+		const char * get_data() const
+		{
+			return data;
+		}
+
+		std::size_t get_size() const
+		{
+			return size;
+		}
+
+		const std::vector< std::uint64_t > & get_offsets() const
+		{
+			return offsets;
+		}
+
+	public:
+		bool empty() const
+		{
+			return offsets.empty();
+		}
+
+		std::size_t count() const
+		{
+			return offsets.size();
+		}
+
+		document_view operator[]( std::size_t i ) const
+		{
+			std::size_t end = i + 1 < offsets.size() ? static_cast<std::size_t>( offsets[i + 1] ) : size;
+
+			return document_view( data + offsets[i], end - static_cast<std::size_t>( offsets[i] ) );
+		}
+
+	public:
+		void build_index()
+		{
+			offsets = split_documents( data, size );
+		}
+
+		// sidecar layout: "BSONIDX1", u64 dump size, u64 count, u64 offsets[count]
+		void save_index( const std::string & path ) const
+		{
+			std::ofstream ofs( path, std::ios::binary | std::ios::trunc );
+
+			std::uint64_t header[2] = { size, offsets.size() };
+
+			ofs.write( "BSONIDX1", 8 );
+			ofs.write( reinterpret_cast<const char *>( header ), sizeof( header ) );
+			ofs.write( reinterpret_cast<const char *>( offsets.data() ), offsets.size() * sizeof( std::uint64_t ) );
+
+			if( !ofs )
+			{
+				throw std::runtime_error( "void save_index( const std::string & path ) const" );
+			}
+		}
+
+		bool load_index( const std::string & path )
+		{
+			std::ifstream ifs( path, std::ios::binary );
+
+			char magic[8] = {};
+			std::uint64_t header[2] = {};
+
+			ifs.read( magic, sizeof( magic ) );
+			ifs.read( reinterpret_cast<char *>( header ), sizeof( header ) );
+			if( !ifs || std::memcmp( magic, "BSONIDX1", 8 ) != 0 || header[0] != size || header[1] > size / 5 )
+			{
+				return false;
+			}
+
+			std::vector< std::uint64_t > result( static_cast<std::size_t>( header[1] ) );
+
+			ifs.read( reinterpret_cast<char *>( result.data() ), result.size() * sizeof( std::uint64_t ) );
+			if( !ifs )
+			{
+				return false;
+			}
+
+			// a stale or foreign index must describe exactly the documents in this dump
+			for( std::size_t i = 0; i < result.size(); i++ )
+			{
+				std::uint64_t end = i + 1 < result.size() ? result[i + 1] : size;
+
+				if( ( i == 0 && result[i] != 0 ) || result[i] >= end || end - result[i] < 5 || raw_load< std::int32_t >( data + result[i] ) != static_cast<std::int64_t>( end - result[i] ) )
+				{
+					return false;
+				}
+			}
+
+			if( result.empty() && size != 0 )
+			{
+				return false;
+			}
+
+			offsets = std::move( result );
+
+			return true;
+		}
+
+	private:
+		void map( const std::string & path )
 		{
-			auto elem = element< element_type::string_node >();
+#ifdef WIN32
+			HANDLE file = CreateFileA( path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr );
+			if( file == INVALID_HANDLE_VALUE )
+			{
+				throw std::runtime_error( "void map( const std::string & path )" );
+			}
 
-			elem.from_json( is );
+			LARGE_INTEGER length;
+			GetFileSizeEx( file, &length );
 
-			if( elem.get_value().front() == '$' )
+			size = static_cast<std::size_t>( length.QuadPart );
+			if( size != 0 )
 			{
-				assert( !is.eof() && sget( is ) == ':' && "template< typename ... T > void node_from_json( std::istream & is, std::variant< T... > & node )" );
+				mapping = CreateFileMappingA( file, nullptr, PAGE_READONLY, 0, 0, nullptr );
+				data = mapping != nullptr ? static_cast<const char *>( MapViewOfFile( mapping, FILE_MAP_READ, 0, 0, 0 ) ) : nullptr;
+			}
 
-				if( elem.get_value() == "$oid" )
-				{
-					auto oid = element< element_type::object_id_node >();
-					oid.from_json( is );
-					node = std::move( oid );
-				}
-				else if( elem.get_value() == "$date" )
-				{
-					auto date = element< element_type::datetime_node >();
-					date.from_json( is );
-					node = std::move( date );
-				}
-				else if( elem.get_value() == "$numberDouble" )
-				{
-					auto dou = element< element_type::double_node >();
-					dou.from_json( is );
-					node = std::move( dou );
-				}
-				else if( elem.get_value() == "$minKey" )
-				{
-					auto min = element< element_type::min_key_node >();
-					min.from_json( is );
-					node = std::move( min );
-				}
-				else if( elem.get_value() == "$maxKey" )
-				{
-					auto max = element< element_type::max_key_node >();
-					max.from_json( is );
-					node = std::move( max );
-				}
-				else if( elem.get_value() == "$timestamp" )
-				{
-					auto time = element< element_type::timestamp_node >();
-					time.from_json( is );
-					node = std::move( time );
-				}
-				else if( elem.get_value() == "$binary" )
-				{
-					auto time = element< element_type::binary_node >();
-					time.from_json( is );
-					node = std::move( time );
-				}
-				else if( elem.get_value() == "$regularExpression" )
-				{
-					auto reg = element< element_type::regular_node >();
-					reg.from_json( is );
-					node = std::move( reg );
-				}
-				else
-				{
-					assert( false && "template< typename ... T > void node_from_json( std::istream & is, std::variant< T... > & node )" );
-				}
+			CloseHandle( file );
+#else
+			int file = ::open( path.c_str(), O_RDONLY );
+			if( file < 0 )
+			{
+				throw std::runtime_error( "void map( const std::string & path )" );
 			}
-			else if( elem.get_value() == "NaN" )
+
+			struct stat st;
+			fstat( file, &st );
+
+			size = static_cast<std::size_t>( st.st_size );
+			if( size != 0 )
 			{
-				node = element<element_type::double_node>( std::numeric_limits<double>::quiet_NaN() );
+				void * addr = mmap( nullptr, size, PROT_READ, MAP_PRIVATE, file, 0 );
+				data = addr != MAP_FAILED ? static_cast<const char *>( addr ) : nullptr;
 			}
-			else if( elem.get_value() == "Infinity" )
+
+			::close( file );
+#endif // WIN32
+			if( size != 0 && data == nullptr )
 			{
-				node = element<element_type::double_node>( std::numeric_limits<double>::infinity() );
+				unmap();
+
+				throw std::runtime_error( "void map( const std::string & path )" );
 			}
-			else if( elem.get_value() == "-Infinity" )
+		}
+
+		void unmap()
+		{
+#ifdef WIN32
+			if( data != nullptr )
 			{
-				node = element<element_type::double_node>( -std::numeric_limits<double>::infinity() );
+				UnmapViewOfFile( data );
 			}
-			else
+			if( mapping != nullptr )
 			{
-				node = std::move( elem );
+				CloseHandle( mapping );
 			}
+			mapping = nullptr;
+#else
+			if( data != nullptr )
+			{
+				munmap( const_cast<char *>( data ), size );
+			}
+#endif // WIN32
+			data = nullptr;
+			size = 0;
 		}
-		break;
-		case '{':
+
+	private:
+		const char * data = nullptr;
+		std::size_t size = 0;
+		std::vector< std::uint64_t > offsets;
+#ifdef WIN32
+		HANDLE mapping = nullptr;
+#endif // WIN32
+	};
+
+	// resource is shared by every worker and must be thread safe, as the default one is
+	inline std::vector< document_t > decode_batch( const char * data, std::size_t size, std::size_t threads = 0, std::pmr::memory_resource * resource = std::pmr::get_default_resource() )
+	{
+		static constexpr std::size_t chunk = 64;
+
+		auto offsets = split_documents( data, size );
+
+		std::vector< document_t > result;
+		result.reserve( offsets.size() );
+		for( std::size_t i = 0; i < offsets.size(); i++ )
 		{
-			auto pos = is.tellg();
+			result.emplace_back( resource );
+		}
 
-			if( sget( is ) == '{' && sget( is ) == '\"' && sget( is ) == '$' )
-			{
-				pos += 1;
-				is.seekg( pos );
+		if( threads == 0 )
+		{
+			threads = std::thread::hardware_concurrency();
+		}
+		if( threads > ( offsets.size() + chunk - 1 ) / chunk )
+		{
+			threads = ( offsets.size() + chunk - 1 ) / chunk;
+		}
+		if( threads == 0 )
+		{
+			threads = 1;
+		}
 
-				node_from_json( is, node );
+		std::atomic< std::size_t > next( 0 );
+		std::atomic< bool > failed( false );
+		std::exception_ptr error;
 
-				assert( smatch( is, "}" ) && "template< typename ... T > void node_from_json( std::istream & is, std::variant< T... > & node )" );
-			}
-			else
+		auto worker = [&]()
+		{
+			try
 			{
-				is.seekg( pos );
+				for( std::size_t beg = next.fetch_add( chunk ); beg < offsets.size() && !failed; beg = next.fetch_add( chunk ) )
+				{
+					for( std::size_t i = beg; i < offsets.size() && i < beg + chunk; i++ )
+					{
+						std::size_t end = i + 1 < offsets.size() ? static_cast<std::size_t>( offsets[i + 1] ) : size;
 
-				auto doc = element< element_type::document_node >();
-				doc.from_json( is );
-				node = std::move( doc );
+						result[i].deserialize( document_view( data + offsets[i], end - static_cast<std::size_t>( offsets[i] ) ) );
+					}
+				}
+			}
+			catch( ... )
+			{
+				if( !failed.exchange( true ) )
+				{
+					error = std::current_exception();
+				}
 			}
+		};
+
+		std::vector< std::thread > pool;
+		for( std::size_t i = 1; i < threads; i++ )
+		{
+			pool.emplace_back( worker );
 		}
-		break;
-		case '[':
+
+		worker();
+
+		for( auto & it : pool )
 		{
-			auto arr = element< element_type::array_node >();
-			arr.from_json( is );
-			node = std::move( arr );
+			it.join();
 		}
-		break;
-		case 'n':
+
+		if( error )
 		{
-			auto elem = element<element_type::null_node>();
-			elem.from_json( is );
-			node = std::move( elem );
+			std::rethrow_exception( error );
 		}
-		break;
-		case 't':
-		case 'f':
+
+		return result;
+	}
+
+	// newline delimited output, workers render chunks ahead of the writer by at most a bounded window
+	inline void export_json( std::ostream & os, const char * data, std::size_t size, const std::vector< std::uint64_t > & offsets, std::size_t threads = 0 )
+	{
+		static constexpr std::size_t chunk = 64;
+
+		struct slot
 		{
-			auto elem = element<element_type::boolean_node>();
-			elem.from_json( is );
-			node = std::move( elem );
+			std::string text;
+			bool ready = false;
+		};
+
+		std::size_t chunks = ( offsets.size() + chunk - 1 ) / chunk;
+
+		if( threads == 0 )
+		{
+			threads = std::thread::hardware_concurrency();
 		}
-		break;
-		default:
-			if( !is.eof() && ( speek( is ) >= '0' && speek( is ) <= '9' ) || speek( is ) == '.' || speek( is ) == '-' )
-			{
-				std::string num;
+		if( threads > chunks )
+		{
+			threads = chunks;
+		}
+		if( threads == 0 )
+		{
+			threads = 1;
+		}
+
+		std::vector< slot > slots( threads * 4 );
+
+		std::mutex mutex;
+		std::condition_variable cond;
+		std::size_t next = 0, written = 0;
+		bool failed = false;
+		std::exception_ptr error;
 
-				while( !is.eof() && ( speek( is ) >= '0' && speek( is ) <= '9' ) || speek( is ) == '.' || speek( is ) == '-' )
+		auto worker = [&]()
+		{
+			std::string text;
+
+			while( true )
+			{
+				std::size_t k = 0;
 				{
-					num.push_back( sget( is ) );
+					std::unique_lock< std::mutex > lock( mutex );
+
+					cond.wait( lock, [&]() { return failed || next >= chunks || next < written + slots.size(); } );
+					if( failed || next >= chunks )
+					{
+						return;
+					}
+
+					k = next++;
 				}
 
-				if( num.find( '.' ) != std::string::npos )
+				try
 				{
-					node = std::move( element< element_type::double_node >( std::stod( num ) ) );
+					text.clear();
+
+					for( std::size_t i = k * chunk; i < offsets.size() && i < ( k + 1 ) * chunk; i++ )
+					{
+						std::size_t end = i + 1 < offsets.size() ? static_cast<std::size_t>( offsets[i + 1] ) : size;
+
+						bson_to_json( data + offsets[i], end - static_cast<std::size_t>( offsets[i] ), text );
+
+						text.push_back( '\n' );
+					}
 				}
-				else
+				catch( ... )
 				{
-					std::int64_t n = std::stoll( num );
-					if( n > std::numeric_limits<std::int32_t>::max() ||
-						n < std::numeric_limits<std::int32_t>::min() )
+					std::lock_guard< std::mutex > lock( mutex );
+
+					if( !failed )
 					{
-						node = std::move( element< element_type::int64_node >( n ) );
+						failed = true;
+						error = std::current_exception();
 					}
-					else
+
+					cond.notify_all();
+
+					return;
+				}
+
+				{
+					std::lock_guard< std::mutex > lock( mutex );
+
+					slots[k % slots.size()].text.swap( text );
+					slots[k % slots.size()].ready = true;
+				}
+
+				cond.notify_all();
+			}
+		};
+
+		std::vector< std::thread > pool;
+
+		// a throwing writer must still stop and join the workers, or the joinable threads terminate the process
+		try
+		{
+			for( std::size_t i = 0; i < threads; i++ )
+			{
+				pool.emplace_back( worker );
+			}
+
+			std::string text;
+			while( true )
+			{
+				{
+					std::unique_lock< std::mutex > lock( mutex );
+
+					cond.wait( lock, [&]() { return failed || written == chunks || slots[written % slots.size()].ready; } );
+					if( failed || written == chunks )
 					{
-						node = std::move( element< element_type::int32_node >( static_cast<std::int32_t>( n ) ) );
+						break;
 					}
+
+					text.swap( slots[written % slots.size()].text );
+					slots[written % slots.size()].ready = false;
+
+					written++;
 				}
+
+				cond.notify_all();
+
+				os.write( text.data(), text.size() );
 			}
-			else
+		}
+		catch( ... )
+		{
+			std::lock_guard< std::mutex > lock( mutex );
+
+			if( !failed )
 			{
-				throw std::runtime_error( "template< typename ... T > void node_from_json( std::istream & is, std::variant< T... > & node )" );
+				failed = true;
+				error = std::current_exception();
 			}
-			break;
+
+			cond.notify_all();
 		}
-	}
 
-	using null_t = element< element_type::null_node >;
-	using int32_t = element< element_type::int32_node >;
-	using int64_t = element< element_type::int64_node >;
-	using array_t = element< element_type::array_node >;
-	using double_t = element< element_type::double_node >;
-	using string_t = element< element_type::string_node >;
-	using binary_t = element< element_type::binary_node >;
-	using boolean_t = element< element_type::boolean_node >;
-	using min_key_t = element< element_type::min_key_node >;
-	using max_key_t = element< element_type::max_key_node >;
-	using regular_t = element< element_type::regular_node >;
-	using datetime_t = element< element_type::datetime_node >;
-	using document_t = element< element_type::document_node >;
-	using timestamp_t = element< element_type::timestamp_node >;
-	using object_id_t = element< element_type::object_id_node >;
+		for( auto & it : pool )
+		{
+			it.join();
+		}
 
-	using node_t = std::variant< 
-		std::monostate,
-		null_t,
-		int32_t,
-		int64_t,
-		array_t,
-		double_t,
-		string_t,
-		binary_t,
-		boolean_t,
-		min_key_t,
-		max_key_t,
-		regular_t,
-		datetime_t,
-		document_t,
-		timestamp_t,
-		object_id_t
-	>;
+		if( error )
+		{
+			std::rethrow_exception( error );
+		}
+	}
+	inline void export_json( std::ostream & os, const char * data, std::size_t size, std::size_t threads = 0 )
+	{
+		export_json( os, data, size, split_documents( data, size ), threads );
+	}
+	inline void export_json( std::ostream & os, const mapped_file & file, std::size_t threads = 0 )
+	{
+		export_json( os, file.get_data(), file.get_size(), file.get_offsets(), threads );
+	}
 }
 
+// maps the listed public members of a struct onto a bson document, use at global scope:
+//   BSON_DEFINE_FIELDS( order, id, price, items )
+#define BSON_EXPAND( X ) X
+#define BSON_CONCAT_( A, B ) A##B
+#define BSON_CONCAT( A, B ) BSON_CONCAT_( A, B )
+#define BSON_NARGS_( _1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, _17, _18, _19, _20, _21, _22, _23, _24, _25, _26, _27, _28, _29, _30, _31, _32, N, ... ) N
+#define BSON_NARGS( ... ) BSON_EXPAND( BSON_NARGS_( __VA_ARGS__, 32, 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17, 16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1 ) )
+#define BSON_FIELD( TYPE, NAME ) bson::make_field( #NAME, &TYPE::NAME )
+#define BSON_FIELDS_1( TYPE, NAME ) BSON_FIELD( TYPE, NAME )
+#define BSON_FIELDS_2( TYPE, NAME, ... ) BSON_FIELD( TYPE, NAME ), BSON_EXPAND( BSON_FIELDS_1( TYPE, __VA_ARGS__ ) )
+#define BSON_FIELDS_3( TYPE, NAME, ... ) BSON_FIELD( TYPE, NAME ), BSON_EXPAND( BSON_FIELDS_2( TYPE, __VA_ARGS__ ) )
+#define BSON_FIELDS_4( TYPE, NAME, ... ) BSON_FIELD( TYPE, NAME ), BSON_EXPAND( BSON_FIELDS_3( TYPE, __VA_ARGS__ ) )
+#define BSON_FIELDS_5( TYPE, NAME, ... ) BSON_FIELD( TYPE, NAME ), BSON_EXPAND( BSON_FIELDS_4( TYPE, __VA_ARGS__ ) )
+#define BSON_FIELDS_6( TYPE, NAME, ... ) BSON_FIELD( TYPE, NAME ), BSON_EXPAND( BSON_FIELDS_5( TYPE, __VA_ARGS__ ) )
+#define BSON_FIELDS_7( TYPE, NAME, ... ) BSON_FIELD( TYPE, NAME ), BSON_EXPAND( BSON_FIELDS_6( TYPE, __VA_ARGS__ ) )
+#define BSON_FIELDS_8( TYPE, NAME, ... ) BSON_FIELD( TYPE, NAME ), BSON_EXPAND( BSON_FIELDS_7( TYPE, __VA_ARGS__ ) )
+#define BSON_FIELDS_9( TYPE, NAME, ... ) BSON_FIELD( TYPE, NAME ), BSON_EXPAND( BSON_FIELDS_8( TYPE, __VA_ARGS__ ) )
+#define BSON_FIELDS_10( TYPE, NAME, ... ) BSON_FIELD( TYPE, NAME ), BSON_EXPAND( BSON_FIELDS_9( TYPE, __VA_ARGS__ ) )
+#define BSON_FIELDS_11( TYPE, NAME, ... ) BSON_FIELD( TYPE, NAME ), BSON_EXPAND( BSON_FIELDS_10( TYPE, __VA_ARGS__ ) )
+#define BSON_FIELDS_12( TYPE, NAME, ... ) BSON_FIELD( TYPE, NAME ), BSON_EXPAND( BSON_FIELDS_11( TYPE, __VA_ARGS__ ) )
+#define BSON_FIELDS_13( TYPE, NAME, ... ) BSON_FIELD( TYPE, NAME ), BSON_EXPAND( BSON_FIELDS_12( TYPE, __VA_ARGS__ ) )
+#define BSON_FIELDS_14( TYPE, NAME, ... ) BSON_FIELD( TYPE, NAME ), BSON_EXPAND( BSON_FIELDS_13( TYPE, __VA_ARGS__ ) )
+#define BSON_FIELDS_15( TYPE, NAME, ... ) BSON_FIELD( TYPE, NAME ), BSON_EXPAND( BSON_FIELDS_14( TYPE, __VA_ARGS__ ) )
+#define BSON_FIELDS_16( TYPE, NAME, ... ) BSON_FIELD( TYPE, NAME ), BSON_EXPAND( BSON_FIELDS_15( TYPE, __VA_ARGS__ ) )
+#define BSON_FIELDS_17( TYPE, NAME, ... ) BSON_FIELD( TYPE, NAME ), BSON_EXPAND( BSON_FIELDS_16( TYPE, __VA_ARGS__ ) )
+#define BSON_FIELDS_18( TYPE, NAME, ... ) BSON_FIELD( TYPE, NAME ), BSON_EXPAND( BSON_FIELDS_17( TYPE, __VA_ARGS__ ) )
+#define BSON_FIELDS_19( TYPE, NAME, ... ) BSON_FIELD( TYPE, NAME ), BSON_EXPAND( BSON_FIELDS_18( TYPE, __VA_ARGS__ ) )
+#define BSON_FIELDS_20( TYPE, NAME, ... ) BSON_FIELD( TYPE, NAME ), BSON_EXPAND( BSON_FIELDS_19( TYPE, __VA_ARGS__ ) )
+#define BSON_FIELDS_21( TYPE, NAME, ... ) BSON_FIELD( TYPE, NAME ), BSON_EXPAND( BSON_FIELDS_20( TYPE, __VA_ARGS__ ) )
+#define BSON_FIELDS_22( TYPE, NAME, ... ) BSON_FIELD( TYPE, NAME ), BSON_EXPAND( BSON_FIELDS_21( TYPE, __VA_ARGS__ ) )
+#define BSON_FIELDS_23( TYPE, NAME, ... ) BSON_FIELD( TYPE, NAME ), BSON_EXPAND( BSON_FIELDS_22( TYPE, __VA_ARGS__ ) )
+#define BSON_FIELDS_24( TYPE, NAME, ... ) BSON_FIELD( TYPE, NAME ), BSON_EXPAND( BSON_FIELDS_23( TYPE, __VA_ARGS__ ) )
+#define BSON_FIELDS_25( TYPE, NAME, ... ) BSON_FIELD( TYPE, NAME ), BSON_EXPAND( BSON_FIELDS_24( TYPE, __VA_ARGS__ ) )
+#define BSON_FIELDS_26( TYPE, NAME, ... ) BSON_FIELD( TYPE, NAME ), BSON_EXPAND( BSON_FIELDS_25( TYPE, __VA_ARGS__ ) )
+#define BSON_FIELDS_27( TYPE, NAME, ... ) BSON_FIELD( TYPE, NAME ), BSON_EXPAND( BSON_FIELDS_26( TYPE, __VA_ARGS__ ) )
+#define BSON_FIELDS_28( TYPE, NAME, ... ) BSON_FIELD( TYPE, NAME ), BSON_EXPAND( BSON_FIELDS_27( TYPE, __VA_ARGS__ ) )
+#define BSON_FIELDS_29( TYPE, NAME, ... ) BSON_FIELD( TYPE, NAME ), BSON_EXPAND( BSON_FIELDS_28( TYPE, __VA_ARGS__ ) )
+#define BSON_FIELDS_30( TYPE, NAME, ... ) BSON_FIELD( TYPE, NAME ), BSON_EXPAND( BSON_FIELDS_29( TYPE, __VA_ARGS__ ) )
+#define BSON_FIELDS_31( TYPE, NAME, ... ) BSON_FIELD( TYPE, NAME ), BSON_EXPAND( BSON_FIELDS_30( TYPE, __VA_ARGS__ ) )
+#define BSON_FIELDS_32( TYPE, NAME, ... ) BSON_FIELD( TYPE, NAME ), BSON_EXPAND( BSON_FIELDS_31( TYPE, __VA_ARGS__ ) )
+#define BSON_DEFINE_FIELDS( TYPE, ... ) \
+	template<> struct bson::traits< TYPE > : bson::struct_traits< TYPE > \
+	{ \
+		static constexpr auto fields() \
+		{ \
+			return std::make_tuple( BSON_EXPAND( BSON_CONCAT( BSON_FIELDS_, BSON_NARGS( __VA_ARGS__ ) )( TYPE, __VA_ARGS__ ) ) ); \
+		} \
+	};
+
 #endif//BSON_HPP__B008D87D_A662_47B8_8066_0121BFDF3473
@@ -0,0 +1,138 @@
+#include <random>
+#include <string>
+#include <iostream>
+
+#include "../bson.hpp"
+
+static std::string reference_encode( const std::string & in )
+{
+	static const char table[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+	std::string out;
+
+	std::size_t i = 0;
+	for( ; i + 3 <= in.size(); i += 3 )
+	{
+		unsigned v = ( static_cast<unsigned char>( in[i] ) << 16 ) | ( static_cast<unsigned char>( in[i + 1] ) << 8 ) | static_cast<unsigned char>( in[i + 2] );
+		out += table[v >> 18];
+		out += table[( v >> 12 ) & 63];
+		out += table[( v >> 6 ) & 63];
+		out += table[v & 63];
+	}
+
+	if( in.size() - i == 1 )
+	{
+		unsigned v = static_cast<unsigned char>( in[i] ) << 16;
+		out += table[v >> 18];
+		out += table[( v >> 12 ) & 63];
+		out += "==";
+	}
+	else if( in.size() - i == 2 )
+	{
+		unsigned v = ( static_cast<unsigned char>( in[i] ) << 16 ) | ( static_cast<unsigned char>( in[i + 1] ) << 8 );
+		out += table[v >> 18];
+		out += table[( v >> 12 ) & 63];
+		out += table[( v >> 6 ) & 63];
+		out += "=";
+	}
+
+	return out;
+}
+
+static std::string encode( const std::string & in )
+{
+	std::string out( bson::base64_encode_size( in.size() ), 0 );
+
+	char * end = bson::base64_encode( out.data(), in.data(), in.size() );
+	if( end != out.data() + out.size() )
+	{
+		return {};
+	}
+
+	return out;
+}
+
+static std::string decode( const std::string & in )
+{
+	std::string out( bson::base64_decode_size( in.size() ), 0 );
+
+	out.resize( bson::base64_decode( out.data(), in.data(), in.size() ) - out.data() );
+
+	return out;
+}
+
+int main()
+{
+	int failures = 0;
+	std::mt19937 rng( 42 );
+
+	// every length up to a few AVX2 blocks covers the three padding cases on both paths
+	for( std::size_t size = 0; size < 400; size++ )
+	{
+		for( int round = 0; round < 4; round++ )
+		{
+			std::string in( size, 0 );
+			for( auto & c : in )
+			{
+				c = static_cast<char>( rng() );
+			}
+
+			std::string text = encode( in );
+			if( text != reference_encode( in ) )
+			{
+				std::cerr << "encode mismatch at size " << size << std::endl;
+				failures++;
+			}
+
+			if( decode( text ) != in )
+			{
+				std::cerr << "decode mismatch at size " << size << std::endl;
+				failures++;
+			}
+
+			std::string spaced;
+			for( std::size_t i = 0; i < text.size(); i++ )
+			{
+				spaced += text[i];
+				if( i % 37 == 36 )
+				{
+					spaced += "\r\n";
+				}
+				else if( i % 11 == 10 )
+				{
+					spaced += ' ';
+				}
+			}
+
+			if( decode( spaced ) != in )
+			{
+				std::cerr << "decode with whitespace mismatch at size " << size << std::endl;
+				failures++;
+			}
+		}
+	}
+
+	// one odd byte in an otherwise valid block: alphabet characters decode, everything else is skipped
+	for( int b = 0; b < 256; b++ )
+	{
+		std::string block( 64, 'A' );
+		block[5] = static_cast<char>( b );
+
+		bool alphabet = ( b >= 'A' && b <= 'Z' ) || ( b >= 'a' && b <= 'z' ) || ( b >= '0' && b <= '9' ) || b == '+' || b == '/';
+		std::size_t expect = alphabet ? 48 : b == '=' ? 3 : 47;
+
+		std::size_t got = decode( block ).size();
+		if( got != expect )
+		{
+			std::cerr << "byte " << b << " decoded to " << got << " bytes, expected " << expect << std::endl;
+			failures++;
+		}
+	}
+
+	if( failures == 0 )
+	{
+		std::cout << "base64: all tests passed" << std::endl;
+	}
+
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,78 @@
+#include <string>
+#include <optional>
+#include <iostream>
+
+#include "../bson.hpp"
+
+static int failures = 0;
+
+template< typename F > static void throws( const char * name, F && func )
+{
+	try
+	{
+		func();
+
+		std::cerr << name << ": did not throw" << std::endl;
+		failures++;
+	}
+	catch( const std::runtime_error & )
+	{
+	}
+}
+
+int main()
+{
+	{
+		bson::builder build;
+		build.open_array( "a" ).push_back( 1 ).push_back( std::optional<int>() ).push_back( std::optional<int>( 3 ) ).close();
+		build.append( "o", std::optional<int>() );
+
+		std::string json;
+		auto view = build.finish();
+		bson::bson_to_json( view.get_data(), view.get_size(), json );
+
+		if( json != R"({ "a" : [ 1, null, 3 ] })" )
+		{
+			std::cerr << "empty optional: got " << json << std::endl;
+			failures++;
+		}
+	}
+
+	// once the root is sealed, nothing may be written behind its length prefix
+	{
+		bson::builder build;
+		build.append( "x", 1 );
+		build.finish();
+
+		std::vector<char> sealed = build.get_buffer();
+
+		throws( "append after finish", [&]() { build.append( "y", 2 ); } );
+		throws( "open_document after finish", [&]() { build.open_document( "d" ); } );
+		throws( "open_array after finish", [&]() { build.open_array( "a" ); } );
+		throws( "push_back after finish", [&]() { build.push_back( 2 ); } );
+		throws( "finish twice", [&]() { build.finish(); } );
+		throws( "close after finish", [&]() { build.close(); } );
+
+		if( build.get_buffer() != sealed )
+		{
+			std::cerr << "buffer changed after finish" << std::endl;
+			failures++;
+		}
+	}
+
+	{
+		bson::builder build;
+		throws( "close at root", [&]() { build.close(); } );
+		throws( "push_back into a document", [&]() { build.push_back( 1 ); } );
+
+		build.open_document( "d" );
+		throws( "finish with an open document", [&]() { build.finish(); } );
+	}
+
+	if( failures == 0 )
+	{
+		std::cout << "builder: all tests passed" << std::endl;
+	}
+
+	return failures == 0 ? 0 : 1;
+}
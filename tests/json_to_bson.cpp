@@ -0,0 +1,131 @@
+#include <limits>
+#include <string>
+#include <sstream>
+#include <iostream>
+
+#include "../bson.hpp"
+
+static int failures = 0;
+
+static void round_trip( const char * name, bson::node_t && value )
+{
+	bson::document_t doc;
+	doc["v"] = std::move( value );
+
+	std::vector<char> expect;
+	doc.serialize_to( expect );
+
+	std::string json;
+	bson::bson_to_json( expect.data(), expect.size(), json );
+
+	try
+	{
+		std::vector<char> view_out;
+		bson::json_to_bson( std::string_view( json ), view_out );
+
+		std::stringstream ss( json );
+		std::vector<char> stream_out;
+		bson::json_to_bson( ss, stream_out );
+
+		if( view_out != expect || stream_out != expect )
+		{
+			std::cerr << name << ": round trip mismatch for " << json << std::endl;
+			failures++;
+		}
+
+		// the DOM front ends read the same text
+		bson::json_reader reader( json );
+		bson::document_t reader_doc;
+		reader_doc.from_json( reader );
+
+		std::stringstream dom_ss( json );
+		bson::document_t stream_doc;
+		stream_doc.from_json( dom_ss );
+
+		std::vector<char> reader_out, stream_doc_out;
+		reader_doc.serialize_to( reader_out );
+		stream_doc.serialize_to( stream_doc_out );
+
+		if( reader_out != expect || stream_doc_out != expect )
+		{
+			std::cerr << name << ": document_t::from_json mismatch for " << json << std::endl;
+			failures++;
+		}
+	}
+	catch( const std::exception & e )
+	{
+		std::cerr << name << ": " << e.what() << " for " << json << std::endl;
+		failures++;
+	}
+}
+
+static void rejects( const char * json )
+{
+	try
+	{
+		std::vector<char> out;
+		bson::json_to_bson( std::string_view( json ), out );
+
+		std::cerr << "accepted malformed " << json << std::endl;
+		failures++;
+	}
+	catch( const std::exception & )
+	{
+	}
+}
+
+int main()
+{
+	round_trip( "null", bson::null_t() );
+	round_trip( "true", bson::boolean_t( true ) );
+	round_trip( "false", bson::boolean_t( false ) );
+	round_trip( "$minKey", bson::min_key_t() );
+	round_trip( "$maxKey", bson::max_key_t() );
+	round_trip( "$oid", bson::object_id_t( std::string_view( "6ad22103b9556404255d6801" ) ) );
+	round_trip( "$date", bson::datetime_t( std::time_t( 1600000000123 ) ) );
+	round_trip( "$date epoch", bson::datetime_t( std::time_t( 0 ) ) );
+	round_trip( "$date before epoch", bson::datetime_t( std::time_t( -1500 ) ) );
+	round_trip( "$timestamp", bson::timestamp_t( std::uint64_t( 1600000000 ) ) );
+	round_trip( "NaN", bson::double_t( std::numeric_limits<double>::quiet_NaN() ) );
+	round_trip( "-Infinity", bson::double_t( -std::numeric_limits<double>::infinity() ) );
+	round_trip( "$binary", bson::binary_t( std::string( "hello world!" ), bson::binary_type::uuid ) );
+	round_trip( "$binary user subtype", bson::binary_t( std::string( "hello world!" ), static_cast<bson::binary_type>( 0x80 ) ) );
+	round_trip( "$regularExpression", bson::regular_t( "a.*", "i" ) );
+	round_trip( "empty array", bson::array_t() );
+	round_trip( "empty document", bson::document_t() );
+
+	{
+		std::vector<char> out;
+		bson::json_to_bson( std::string_view( R"({ "v" : { "$numberDouble" : "1.5" } })" ), out );
+
+		bson::document_t doc;
+		doc["v"] = bson::double_t( 1.5 );
+
+		std::vector<char> expect;
+		doc.serialize_to( expect );
+
+		if( out != expect )
+		{
+			std::cerr << "$numberDouble: quoted number mismatch" << std::endl;
+			failures++;
+		}
+	}
+
+	rejects( R"({ "v" : nul })" );
+	rejects( R"({ "v" : ture })" );
+	rejects( R"({ "v" : { "$minKey" : 2 } })" );
+	rejects( R"({ "v" : { "$maxKey" : 0 } })" );
+	rejects( R"({ "v" : { "$oid" : "6ad22103" } })" );
+	rejects( R"({ "v" : { "$oid" : 42 } })" );
+	rejects( R"({ "v" : { "$date" : "yesterday" } })" );
+	rejects( R"({ "v" : { "$date" : "2020-13-13T12:26:40.123Z" } })" );
+	rejects( R"({ "v" : { "$timestamp" : { "t" : 5 } } })" );
+	rejects( R"({ "v" : { "$timestamp" : 5 } })" );
+
+	if( failures == 0 )
+	{
+		std::cout << "json_to_bson: all tests passed" << std::endl;
+	}
+
+	return failures == 0 ? 0 : 1;
+}